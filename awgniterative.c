@@ -8,11 +8,14 @@
 
 	Output format of simulation results
 	snr pb pB var #ebits #bits #eblks #blks aveitr 
-	seed maxi N M file stop #err
+	seed maxi N M file stop #err pb_lo pb_hi pB_lo pB_hi
 
 	Symbols
 
-	snr   : Eb/N0
+	snr   : Eb/N0. As an argument also a list of points
+	        (1.0,1.5,2.5) or a range first:step:last
+	        (1.0:0.25:3.0); the matrix is read once and a
+	        line of results is printed for each point.
 	pb    : bit error probability after decoding 
 	pB    : block error probability after decoding 
 	var   : variance of the noise
@@ -30,7 +33,198 @@
 	        0->simulation stops when #ebits becomes #err
 	        1->simulation stops when #eblks becomes #err
 	#err  : number of errors enough to stop a simulation
+	        (with -ci: the least number of errors)
+	pb_lo pb_hi pB_lo pB_hi: 95% confidence intervals of
+	        pb and pB
 	disp  : display mode(disp = 1: display)
+
+	Options (-name value, may be placed anywhere):
+	-alg  : decoding algorithm
+	        prob -> sum-product with probability pairs (default)
+	        llr  -> sum-product with log-likelihood ratios
+	        ms   -> min-sum
+	        nms  -> normalized min-sum (scaling factor -alpha)
+	        oms  -> offset min-sum (offset -beta)
+	        gala -> Gallager-A on the hard decisions of the
+	                received word
+	        galb -> Gallager-B (a bit sends its flipped
+	                channel bit when more than half of its
+	                other checks disagree)
+	        bf   -> parallel bit flipping on the hard
+	                decisions (all bits with more unsatisfied
+	                than satisfied checks flip)
+	        The hard-decision decoders are bitsliced: 64
+	        frames are decoded at once by XOR and AND on
+	        uint64_t words (-lanes, on by default for them).
+	-alpha: scaling factor of normalized min-sum (default 0.8)
+	-beta : offset of offset min-sum (default 0.15)
+	-q    : bits of a quantized message (2..16, default 0: not
+	        quantized). The min-sum algorithms then run on int8
+	        (up to 8 bits) or int16 messages with saturation.
+	-qch  : bits of a quantized channel LLR (default: same as -q)
+	-qstep: LLR value of one quantization step (default 0.5)
+	-simd : 1 -> rows of equal degree (and columns of equal
+	        degree for -alg prob) are processed LANES at a time
+	        by the vectorized node kernels (default)
+	        0 -> one row (column) at a time
+	-sched: decoding schedule
+	        flood   -> all rows, then all columns (default)
+	        layered -> layered (row-serial) schedule; the a
+	                   posteriori LLRs are updated after each
+	                   layer
+	        shuffled-> shuffled (column-serial) schedule; the
+	                   check messages are refreshed after each
+	                   group of columns from partial states
+	                   of the rows
+	        residual-> residual belief propagation; the row
+	                   whose messages would change most is
+	                   updated first. One iteration is M row
+	                   updates.
+	        With layered, shuffled and residual, -alg prob is
+	        run as -alg llr, which is the same sum-product.
+	-layers: file of the layers of the layered schedule
+	        (default: one row per layer; see init_layers for
+	        the format). Implies -sched layered.
+	-cgroup: columns per group of the shuffled schedule
+	        (default 1)
+	-prec : precision of the floating point decoders
+	        double  -> double precision (default)
+	        float   -> single precision
+	        compare -> both on the same received words; the
+	                   results are those of double and a
+	                   precision report for float is appended
+	-abandon: window W of the failure predictor (default 0:
+	        off). A frame is given up when the number of
+	        unsatisfied checks has not reached a new minimum
+	        for W iterations, or has changed its direction at
+	        each of the last W iterations (oscillation).
+	        Converging frames of min-sum often zig-zag and
+	        stall for 10 or more iterations; W of 20 to 30
+	        keeps the loss in FER small.
+	        Such a frame is counted as a block error, and a
+	        report line (#abandon:) with the number of given
+	        up frames and the iterations saved is appended.
+	-is   : importance sampling of the noise (default off)
+	        shift -> the noise has the mean -B (toward the
+	                 wrong sign of each bit)
+	        scale -> the noise has the variance B*var
+	        Every frame is weighted by the likelihood ratio
+	        of its noise, and a report line (#is:) gives the
+	        weighted pb and pB with the variance of the
+	        estimates. The decoder still assumes the true
+	        variance. The ratio is a product over all the
+	        bits of a word, so B must shrink as N grows; the
+	        relative error (re) shows a bias that is too
+	        strong. A point stops when it has #err (biased)
+	        error events and the weighted estimate is within
+	        the -ci interval (default 0.2 with -is), so that
+	        the count of biased events alone does not end it.
+	-isbias: the bias B of -is (default 1/sqrt(N) for shift
+	        and 1+2/sqrt(N) for scale, which keep the spread
+	        of the log weights of a frame near 1 to 2)
+	-ci   : relative half width W of the 95% confidence
+	        interval of pb (stop = 0) or pB (stop = 1) at
+	        which a point stops, once it has #err errors
+	        (default 0: off; 0.2 with -is). With -is the
+	        weighted estimate is used. The interval of pb is taken over frames
+	        (the errors of a frame are not independent).
+	-maxframes: the most frames of a point (default 0: no
+	        limit)
+	-time : the most seconds of wall-clock time of a point
+	        (default 0: no limit)
+	        The stop rules are checked at the end of each
+	        batch (see -batch). print_results appends the
+	        intervals of pb and pB to each result line.
+	-checkpoint: file to which the counters of every point
+	        are written every -ckint seconds (default 60) and
+	        at the end of the run. Needs -rng philox.
+	-resume: (or --resume) continue the run of a checkpoint
+	        file (with the same matrix, snr, seed, -batch and
+	        options; -checkpoint defaults to the same file).
+	        The options that change the results (-alg, -alpha,
+	        -beta, maxi, stop, -q, -qch, -qstep, -prec,
+	        -sched, -layers, -cgroup, -abandon, -is, -isbias)
+	        are checked. A larger #err continues finished
+	        points.
+	        SIGINT or SIGTERM ends a run after the current
+	        frames: the counted batches are written to the
+	        checkpoint and printed. A second signal kills.
+	-shard: K/S runs shard K (0 ... S-1) of S processes. Shard
+	        K decodes the batches K, K+S, K+2S, ... of every
+	        point, so the frames of the shards are disjoint
+	        (the frame numbers are those of an unsharded run,
+	        for -replay). Each shard stops on its own #err or
+	        budget. Needs -rng philox.
+	-shardout: file of the record of the shard (#shard line
+	        and, per point, the fields of the results and the
+	        counters), written at the end of the run;
+	        mergeshards adds up the records of all shards
+	        and rejects shards of other options (as -resume).
+	-j    : number of worker threads (default 1). Each worker
+	        decodes its own batches of frames (see -batch)
+	        with its own workspace. With -rng drand48 each
+	        worker has its own random number stream (stream
+	        k of the seed, see init_rng), so only -j 1
+	        reproduces the earlier versions.
+	        With a sweep (see snr) the workers start on
+	        different points; a worker whose point is
+	        finished moves to the unfinished point with the
+	        fewest workers.
+	-rng  : random number generator
+	        philox  -> counter-based Philox4x32-10; the noise
+	                   of a frame is made in one pass by the
+	                   ziggurat method (default)
+	        drand48 -> drand48 and the polar Box-Muller
+	                   method, one number per call (the
+	                   generator of the earlier versions)
+	-batch: frames of a point that a worker decodes before
+	        its counters are added to the result of the point
+	        (default 16, 64 for -alg gala, galb and bf with
+	        -lanes). The batches are added in the order
+	        of the frame numbers, and a point stops at the
+	        end of the batch that reaches #err (-batch 1
+	        stops at the frame). With -rng philox the noise
+	        of frame F depends only on the seed, the SNR and
+	        F, so the results do not depend on -j. The
+	        display mode prints a line per batch and the
+	        number of each frame in error.
+	-replay F (or --replay F): decode frame F of each SNR
+	        point alone, with the unsatisfied checks and the
+	        error bits of every iteration and the positions
+	        of the bits in error. Needs -rng philox; use
+	        the seed and the options of the run that
+	        reported the frame.
+	-pipe : D > 0 gives each worker a producer thread that
+	        makes the received words of its batches
+	        ahead into a lock-free ring of D frames, so that
+	        the channel overlaps with the decoding (default
+	        0: off). -j N -pipe D runs 2N threads. With -rng
+	        drand48 the frames made ahead of the end of a
+	        point use up numbers of the stream, so that the
+	        results differ from those without -pipe.
+	-lanes: 1 -> the frames of a batch are decoded LANES at
+	        a time (4 doubles or 8 floats with AVX2), with the
+	        messages of an edge of all the frames in one SIMD
+	        vector; a frame that is decoded leaves its lane
+	        at once and the next frame of the batch takes it
+	        (default 0: off). Only the frames of one batch
+	        are in the lanes, so a -batch smaller than the
+	        lanes leaves lanes idle. The decisions, iterations and
+	        results are the same as without -lanes. Needs
+	        -alg ms, nms or oms, -sched flood and -prec double
+	        or float; not with -q, -abandon, -split or -pipe.
+	        For -alg gala, galb and bf the lanes are the 64
+	        bits of a word, and -lanes is 1 unless -abandon
+	        or -pipe is given.
+	-split: number of threads decoding one frame (default
+	        1). The rows and the columns of each flooding
+	        iteration are divided among a pool of threads
+	        with a barrier between the phases; the messages
+	        are shared, so the memory of a frame does not
+	        grow. For very long codes, where -j would need a
+	        workspace per thread. Needs -sched flood and
+	        floating point decoding; -j N -split T runs N*T
+	        threads.
 	
 	Caution: The error bits are counted over a whole word.
 	It may not be a traditional definition of bit error 
@@ -47,11 +241,42 @@
 	awgniterative 981.500 2.0 (10 123 0 100 0)
 
 	HOW TO MAKE:
-	gcc -O2 -o awgniterative awgniterative.c -lm
+	gcc -O2 -march=native -pthread -o awgniterative awgniterative.c -lm
 
 	HISTORY:
   	SINCE : Jan. 17, 2000
 	Jan.19: bug fix about malloc of bcjr_for0,etc.
+	Oct.16, 2026: linked list of items is replaced by flat edge
+	        arrays (row_start/edge_col, col_start/col_edge)
+	Oct.16, 2026: LLR domain sum-product decoder (-alg llr)
+	Oct.16, 2026: min-sum decoders (-alg ms/nms/oms)
+	Oct.16, 2026: fixed-point min-sum decoders (-q)
+	Oct.16, 2026: single precision decoders (-prec float/compare)
+	Oct.16, 2026: SIMD check node update over rows of equal degree
+	Oct.16, 2026: SIMD variable node update over columns of equal
+	              degree
+	Oct.16, 2026: channel metrics are computed once per frame
+	Oct.16, 2026: layered schedule (-sched layered, -layers)
+	Oct.16, 2026: shuffled schedule (-sched shuffled, -cgroup)
+	Oct.16, 2026: residual belief propagation (-sched residual)
+	Oct.16, 2026: the syndrome is updated incrementally
+	Oct.16, 2026: early abandonment of frames (-abandon)
+	Oct.16, 2026: frame-parallel simulation on worker threads (-j)
+	Oct.16, 2026: intra-frame parallel decoding (-split)
+	Oct.16, 2026: sweep of SNR points in one run (snr list/range)
+	Oct.16, 2026: Philox random numbers and ziggurat noise (-rng)
+	Oct.16, 2026: per-frame random streams and frame replay (-replay)
+	Oct.16, 2026: importance sampling of the noise (-is, -isbias)
+	Oct.16, 2026: stop on a confidence interval and budgets
+	              (-ci, -maxframes, -time)
+	Oct.16, 2026: 64-bit counters, checkpoints (-checkpoint,
+	              -resume) and results on SIGINT/SIGTERM
+	Oct.16, 2026: sharded runs over processes (-shard, -shardout)
+	Oct.16, 2026: pipelined channel and decoding threads (-pipe)
+	Oct.16, 2026: multi-frame SIMD decoding with lane refilling
+	              (-lanes)
+	Oct.16, 2026: bitsliced hard-decision decoders (-alg gala,
+	              galb, bf)
 
 	Copyright (C) Tadashi Wadayama
 
@@ -59,34 +284,90 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
-
-/* =============================================== */
-/*  Each item corresponds to bit with value 1 in H */
-/* =============================================== */
-
-typedef struct _ITEM
-{
-  int n,m;			/* (m,n):the position in H */
-  void *right;		/* The pointer to next item in the same row */
-  void *down;		/* The pointer to next item in the same column*/
-  double r0,r1;
-  double q0,q1;
-} item;
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <signal.h>
+#include <sched.h>
+#include <tgmath.h>
+
+				/* decoding algorithms */
+#define ALG_PROB 0		/* sum-product, probability pairs */
+#define ALG_LLR  1		/* sum-product, log-likelihood ratios */
+#define ALG_MS   2		/* min-sum */
+#define ALG_NMS  3		/* normalized min-sum */
+#define ALG_OMS  4		/* offset min-sum */
+				/* hard-decision, bitsliced */
+				/* (algorithm >= ALG_GALA) */
+#define ALG_GALA 5		/* Gallager-A */
+#define ALG_GALB 6		/* Gallager-B */
+#define ALG_BF   7		/* parallel bit flipping */
+#define HARD_LANES 64		/* frames in a uint64_t */
+
+				/* precision of floating point decoders */
+#define PREC_DOUBLE  0
+#define PREC_FLOAT   1
+#define PREC_COMPARE 2		/* float and double side by side */
+
+				/* decoding schedules */
+#define SCHED_FLOOD   0		/* flooding: all rows, then all columns */
+#define SCHED_LAYERED 1		/* layered (row-serial) */
+#define SCHED_SHUFFLED 2	/* shuffled (column-serial) */
+#define SCHED_RESIDUAL 3	/* residual belief propagation */
+
+				/* bound of phi() in the partial row */
+				/* states of SCHED_SHUFFLED, so that */
+				/* the sums stay finite */
+#define PHI_MAX 30.0
+#define PHI_MIN 1.8716e-13	/* phi(PHI_MAX) */
+
+				/* vector register size for the lane */
+				/* kernels; LANES(T) values of type T */
+				/* are processed by one instruction */
+#if defined(__AVX512F__)
+#define SIMD_BYTES 64
+#elif defined(__AVX__)
+#define SIMD_BYTES 32
+#else
+#define SIMD_BYTES 16
+#endif
+#define LANES(T) ((int)(SIMD_BYTES / sizeof(T)))
+
+				/* alignment of data written by */
+				/* different threads */
+#define CACHE_LINE 64
+
+				/* random number generators */
+#define RNG_PHILOX  0		/* Philox4x32-10 and ziggurat */
+#define RNG_DRAND48 1		/* drand48 and polar Box-Muller */
+
+				/* importance sampling (-is) */
+#define IS_OFF   0		/* plain Monte Carlo */
+#define IS_SHIFT 1		/* mean-shifted noise */
+#define IS_SCALE 2		/* variance-scaled noise */
+
+				/* commands of the intra-frame pool */
+#define SPLIT_ITER64 0		/* one iteration of decoder64 */
+#define SPLIT_ITER32 1		/* one iteration of decoder32 */
 
 /* =============================================== */
 /*  The following is the central data structure.   */
-/*  It represnts a sparce matrix by using linked   */
-/*  list.  Every item in the lists have            */
-/*  the following links to each other              */
+/*  It represents a sparce matrix by flat edge     */
+/*  arrays. Every bit with value 1 in H is an edge */
+/*  and edges are numbered in row-major order.     */
 /*
 
- item -> item -> ...
-  |       |
-  V       V
- item -> item -> ...
-  |       |
-  V       V
+ row m   : edges row_start[m] ... row_start[m+1]-1
+           edge_col[e] is the column of edge e
+ col n   : col_edge[col_start[n]] ... col_edge[col_start[n+1]-1]
+           are the edges in column n (in increasing row order)
+
+   All indices are 32-bit ints; the messages of edge e are stored
+   in the arrays of simulation_parameters at the same index e.
+*/
 /* =============================================== */
 
 typedef struct _SPMATRIX
@@ -97,10 +378,97 @@ typedef struct _SPMATRIX
   int* num_ones_in_row;		/* number of ones in a row of H */
   int biggest_num_ones_col;	/* The biggest number of ones in column */
   int biggest_num_ones_row;	/* The biggest number of ones in row */
-  item* start_col_list;		/* a column list starts from here*/
-  item* start_row_list;		/* a row list starts from here*/
+  int num_edges;		/* number of ones in H */
+  int* row_start;		/* first edge of each row (size M+1) */
+  int* edge_col;		/* column of each edge (size num_edges) */
+  int* col_start;		/* first entry of each column in col_edge */
+  int* col_edge;		/* column->edge permutation (size num_edges) */
+  int* edge_row;		/* row of each edge (size num_edges) */
+  int* col_row;			/* row of each entry of col_edge */
+  int* row_order;		/* rows sorted by degree */
+  int num_row_groups;		/* number of distinct row degrees */
+  int* row_group;		/* rows of group g are row_order[row_group[g]] */
+				/* ... row_order[row_group[g+1]-1] */
+  int* col_order;		/* columns sorted by degree */
+  int num_col_groups;		/* number of distinct column degrees */
+  int* col_group;		/* same as row_group for col_order */
 } sparce_matrix;
 
+/* =============================================== */
+/*  Messages and work areas of the floating point  */
+/*  decoders for a message type T.                 */
+/* =============================================== */
+
+#define WORKSPACE(T)							\
+  struct {								\
+				/* messages on edges (edge order of H) */ \
+    T* r0;			/* check to variable, probability of 0 */ \
+    T* r1;			/* check to variable, probability of 1 */ \
+    T* q0;			/* variable to check, probability of 0 */ \
+    T* q1;			/* variable to check, probability of 1 */ \
+    T* lr;			/* check to variable, LLR */		\
+    T* lq;			/* variable to check, LLR */		\
+				/* for BCJR algorithm */		\
+    T* bcjr_for0;		/* forward probabilty of 0-state */	\
+    T* bcjr_for1;		/* forward probabilty of 1-state */	\
+    T* bcjr_back0;		/* backword probabilty of 0-state */	\
+    T* bcjr_back1;		/* backword probabilty of 1-state */	\
+    T* bcjr_tmp0;		/* likelihood for symbol 0 */		\
+    T* bcjr_tmp1;		/* likelihood for symbol 1 */		\
+    T* bcjr_tmp_q0;							\
+    T* bcjr_tmp_q1;							\
+				/* for updown algorithm */		\
+    T* ud_upward0;		/* upward probabilty of 0-state */	\
+    T* ud_upward1;		/* upward probabilty of 1-state */	\
+    T* ud_downward0;		/* downward probabilty of 0-state */	\
+    T* ud_downward1;		/* downward probabilty of 1-state */	\
+    T* ud_tmp0;								\
+    T* ud_tmp1;								\
+				/* for box-plus algorithm */		\
+    T* llr_phi;			/* phi(|lq|) of the edges in a row */	\
+    T* llr_for;			/* forward sum of phi(|lq|) */		\
+				/* for lane (SIMD) kernels, each */	\
+				/* biggest row or column degree + 1 */	\
+				/* vectors of LANES(T) values */	\
+    T* lane_a0;								\
+    T* lane_a1;								\
+    T* lane_f0;								\
+    T* lane_f1;								\
+    T* lane_b0;								\
+    T* lane_b1;								\
+				/* channel metrics of the frame */	\
+    T* ch0;			/* exp(y/var), likelihood of 0 */	\
+    T* ch1;			/* exp(-y/var), likelihood of 1 */	\
+    T* ch_llr;			/* 2y/var, channel LLR */		\
+    T* post;			/* a posteriori LLR (layered schedule) */ \
+				/* partial states of the rows */	\
+				/* (shuffled schedule) */		\
+    T* sh_phi;			/* phi(|lq|) of each edge (box-plus) */	\
+    T* sh_s1;			/* sum of sh_phi or smallest |lq| */	\
+    T* sh_s2;			/* second smallest |lq| (min-sum) */	\
+    int* sh_pos;		/* edge of sh_s1 (min-sum) */		\
+    int* sh_pos2;		/* edge of sh_s2 (min-sum) */		\
+    int* sh_sign;		/* parity of the signs of lq */		\
+				/* residual belief propagation */	\
+    T* rb_new;			/* candidate check messages */		\
+    T* rb_res;			/* residual of each row */		\
+    int* rb_heap;		/* max-heap of the rows by rb_res */	\
+    int* rb_pos;		/* position of each row in rb_heap */	\
+    int* rb_mark;		/* rows already refreshed in a step */	\
+				/* multi-frame decoding (-lanes): */	\
+				/* one vec of LANES(T) frames per */	\
+				/* edge or column */			\
+    T* fr_lq;			/* variable to check */			\
+    T* fr_lr;			/* check to variable */			\
+    T* fr_ch;			/* channel LLR */			\
+    T* fr_dec;			/* decisions (mask of the lanes) */	\
+    T* tmp_q0;			/* pseudo probability for 0 */		\
+    T* tmp_q1;			/* pseudo probability for 1 */		\
+  }
+
+typedef WORKSPACE(double) workspace64;
+typedef WORKSPACE(float) workspace32;
+
 /* =============================================== */
 /*  The following data structure is used for       */
 /*  storing information related to the simulation. */
@@ -114,63 +482,364 @@ typedef struct _SIM_PARA
   double var;			/* variance of the noise */
   double* rword;		/* received_word */
 
-				/* for BCJR algorithm */
-  double* bcjr_for0;		/* forward probabilty of 0-state */
-  double* bcjr_for1;		/* forward probabilty of 1-state */
-  double* bcjr_back0;		/* backword probabilty of 0-state */
-  double* bcjr_back1;		/* backword probabilty of 1-state */
-  double* bcjr_tmp0;		/* likelihood for symbol 0 */
-  double* bcjr_tmp1;		/* likelihood for symbol 1 */
-  double* bcjr_tmp_q0;
-  double* bcjr_tmp_q1;
-				/* for updown algorithm */
-  double* ud_upward0;		/* upward probabilty of 0-state */
-  double* ud_upward1;		/* upward probabilty of 1-state */
-  double* ud_downward0;		/* downward probabilty of 0-state */
-  double* ud_downward1;		/* downward probabilty of 1-state */
-  double* ud_tmp0;
-  double* ud_tmp1;
-
-  double* tmp_q0;		/* pseudo probability for 0 */
-  double* tmp_q1;		/* pseudo probability for 1 */
+  workspace64 ws64;		/* double precision decoder */
+  workspace32 ws32;		/* single precision decoder */
   int* tmp_decision;		/* temporary decision for each bit */
+  int* syndrome;		/* syndrome bit of each row for tmp_decision */
+  int unsatisfied;		/* number of unsatisfied checks */
 
   int max_iteration;		/* maximum number of iterations */
-  int total_blocks;		/* number of transmitted blocks */
-  int error_blocks;		/* number of error blocks */
-  int total_bits;		/* number of transmitted bits */
-  int error_bits;		/* number of error bits */
+  long long total_blocks;	/* number of transmitted blocks */
+  long long error_blocks;	/* number of error blocks */
+  long long total_bits;		/* number of transmitted bits */
+  long long error_bits;		/* number of error bits */
+  double error_bits2;		/* sum of squares of error bits per block */
   int error_weight_in_word;	/* number of errors within a block */
   int seed;			/* seed for the random number generator */
-  int num_iteration;		/* total number of required iterations */
+  long long num_iteration;	/* total number of required iterations */
   int stop;			/* stop flag*/
   int stop_err;			/* number of errors enough to stop */
+  double ci_width;		/* relative half width of -ci (0: off) */
+  long long max_frames;		/* frames of a point (0: no limit) */
+  double time_budget;		/* seconds of a point (0: no limit) */
   int display;			/* 0->non display mode, 1->display mode */
+  int algorithm;		/* decoding algorithm (ALG_*) */
+  double ms_scale;		/* scaling factor for ALG_NMS */
+  double ms_offset;		/* offset for ALG_OMS */
+  int precision;		/* PREC_DOUBLE, PREC_FLOAT or PREC_COMPARE */
+  int simd;			/* 1: lane kernels for rows and columns */
+  int schedule;			/* SCHED_FLOOD or SCHED_LAYERED */
+  char* layer_file;		/* layers of SCHED_LAYERED (NULL: rows) */
+  int num_layers;		/* number of layers */
+  int* layer_start;		/* rows of layer k are layer_row[layer_start[k]] */
+  int* layer_row;		/* ... layer_row[layer_start[k+1]-1] */
+  int col_group;		/* columns per group of SCHED_SHUFFLED */
+
+				/* for PREC_COMPARE (float results) */
+  int* cmp_decision;		/* decision of the float decoder */
+  long long cmp_error_blocks;	/* number of error blocks */
+  long long cmp_error_bits;	/* number of error bits */
+  long long cmp_num_iteration;	/* total number of iterations */
+  long long cmp_differ_blocks;	/* blocks decoded differently */
+  long long cmp_differ_bits;	/* bits decoded differently */
+
+				/* for early abandonment */
+  int abandon_window;		/* window of the predictor (0: off) */
+  int ab_best;			/* fewest unsatisfied checks so far */
+  int ab_since;			/* iterations since ab_best */
+  int ab_prev;			/* unsatisfied checks of last iteration */
+  int ab_dir;			/* direction of the last change */
+  int ab_swings;		/* consecutive changes of direction */
+  int abandoned;		/* 1: the current frame was given up */
+  long long abandoned_blocks;	/* number of given up blocks */
+  long long abandoned_iterations;	/* iterations saved by giving up */
+
+				/* for importance sampling */
+  int is_method;		/* IS_OFF, IS_SHIFT or IS_SCALE */
+  double is_bias;		/* mean shift or variance factor */
+  double is_weight;		/* likelihood ratio of the frame */
+  double is_blocks;		/* sum of the weights of error blocks */
+  double is_blocks2;		/* ... of their squares */
+  double is_bits;		/* sum of weight * error bits */
+  double is_bits2;		/* ... of their squares */
+
+  int threads;			/* number of worker threads (-j) */
+  int batch;			/* frames per batch of a worker (-batch) */
+  int pipe_depth;		/* slots of the ring of -pipe (0: off) */
+  int frame_lanes;		/* 1: frames decoded in lanes (-lanes) */
+  int split_threads;		/* threads decoding one frame (-split) */
+  struct _SPLIT* split;		/* their pool (NULL: not split) */
+
+				/* random number stream of the worker */
+  int rng_type;			/* RNG_PHILOX or RNG_DRAND48 (-rng) */
+  uint32_t rng_key[2];		/* key of Philox4x32 */
+  uint32_t rng_ctr[4];		/* counter of the next block */
+  uint32_t* rng_buf;		/* words of the last blocks */
+  int rng_pos;			/* next word in rng_buf */
+  unsigned short rng[3];	/* state of erand48 */
+  int nrnd_sw;			/* state of nrnd */
+  double nrnd_r2, nrnd_s;
+  long long replay;		/* frame of -replay (-1: none) */
+  char* ck_file;		/* checkpoint file (NULL: none) */
+  double ck_interval;		/* seconds between checkpoints */
+  char* resume_file;		/* checkpoint to resume (NULL: none) */
+  int shard;			/* index of the shard (-shard K/S) */
+  int num_shards;		/* number of shards */
+  char* shard_file;		/* record of the shard (NULL: none) */
+  char* file;			/* parity check matrix (argument) */
+  int trace;			/* 1: trace of the iterations */
+  int trace_iteration;		/* iterations of the traced frame */
+
+				/* for quantized decoders */
+  int qbits;			/* bits of a message (0: not quantized) */
+  int qch_bits;			/* bits of a channel LLR */
+  double qstep;			/* LLR value of one step */
+  int qmax;			/* saturation level of a message */
+  int qch_max;			/* saturation level of a channel LLR */
+  int qscale;			/* ms_scale in units of 1/16 */
+  int qoffset;			/* ms_offset in steps */
+  signed char* qr8;		/* check to variable (qbits <= 8) */
+  signed char* qq8;		/* variable to check (qbits <= 8) */
+  signed char* qch8;		/* channel LLR (qbits <= 8) */
+  short* qr16;			/* check to variable (qbits > 8) */
+  short* qq16;			/* variable to check (qbits > 8) */
+  short* qch16;			/* channel LLR (qbits > 8) */
+
+				/* for hard-decision decoders, bit l */
+				/* of a word is frame l */
+  uint64_t* hd_ch;		/* channel bits of a column */
+  uint64_t* hd_q;		/* variable to check bits of an edge */
+  uint64_t* hd_r;		/* check to variable bits of an edge */
+  uint64_t* hd_dec;		/* decisions of a column */
+  uint64_t* hd_syn;		/* syndrome bits of a row */
+  int hd_planes;		/* bit planes of a counter */
 } simulation_parameters;
 
+/* ================================================== */
+/*  Counter-based random numbers (-rng philox)        */
+/*  Philox4x32-10 (Salmon et al., SC'11) maps a       */
+/*  128-bit counter and a 64-bit key to 4 random      */
+/*  words. Block j of the stream of a frame has the   */
+/*  counter (j mod 2^32, j / 2^32, frame mod 2^32,    */
+/*  frame / 2^32) and the key (seed, SNR in units of  */
+/*  1e-6 dB) (see init_frame_rng). rng_fill makes     */
+/*  RNG_WORDS/4 blocks at a time, LANES(uint64_t)     */
+/*  blocks per vector operation (a 32-bit value per   */
+/*  64-bit lane, so that one multiplication gives the */
+/*  high and the low half of the product).            */
+/* ================================================== */
+
+#define RNG_WORDS 1024		/* words of rng_buf */
+
+typedef uint64_t rngvec __attribute__((vector_size(SIMD_BYTES)));
+
+void rng_fill(simulation_parameters* p)
+{
+  const int L = LANES(uint64_t);
+  const uint64_t lo = 0xFFFFFFFF;
+  rngvec c0,c1,c2,c3,k0,k1,p0,p1,zero = {0},lane = {0};
+  uint64_t base;
+  uint32_t* buf;
+  int b,l,r;
+
+  for (l = 0; l < L; l++) lane[l] = l;
+  base = ((uint64_t)p->rng_ctr[1] << 32) | p->rng_ctr[0];
+  for (b = 0; b <= RNG_WORDS/4-1; b += L) {
+    c0 = zero + (base + b) + lane;	/* block numbers */
+    c1 = c0 >> 32;
+    c0 &= lo;
+    c2 = zero + p->rng_ctr[2];
+    c3 = zero + p->rng_ctr[3];
+    k0 = zero + p->rng_key[0];
+    k1 = zero + p->rng_key[1];
+    for (r = 0; r <= 9; r++) {	/* 10 rounds */
+      p0 = c0 * 0xD2511F53;
+      p1 = c2 * 0xCD9E8D57;
+      c0 = (p1 >> 32) ^ c1 ^ k0;
+      c1 = p1 & lo;
+      c2 = (p0 >> 32) ^ c3 ^ k1;
+      c3 = p0 & lo;
+      k0 = (k0 + 0x9E3779B9) & lo;
+      k1 = (k1 + 0xBB67AE85) & lo;
+    }
+    buf = p->rng_buf + 4*b;
+    for (l = 0; l < L; l++) {
+      buf[4*l] = c0[l];
+      buf[4*l+1] = c1[l];
+      buf[4*l+2] = c2[l];
+      buf[4*l+3] = c3[l];
+    }
+  }
+  base += RNG_WORDS/4;
+  p->rng_ctr[0] = base & lo;
+  p->rng_ctr[1] = base >> 32;
+  p->rng_pos = 0;
+}
+
+/* next random word of the stream */
+
+static inline uint32_t rng_u32(simulation_parameters* p)
+{
+  if (p->rng_pos == RNG_WORDS) rng_fill(p);
+  return p->rng_buf[p->rng_pos++];
+}
+
+/* uniform random number in (0,1) */
+
+static inline double rng_uniform(simulation_parameters* p)
+{
+  return (rng_u32(p) + 0.5) * (1.0/4294967296.0);
+}
+
+/* ================================================== */
+/*  Ziggurat method for normal random numbers         */
+/*  (Marsaglia and Tsang, 2000) with 128 layers. The  */
+/*  low 7 bits of a word select the layer and the     */
+/*  other 25 bits are the signed value, so that the   */
+/*  two are independent. About 99% of the numbers     */
+/*  cost a word, a table lookup and a comparison; the */
+/*  rest (wedges and tail) are done in zig_fix.       */
+/* ================================================== */
+
+#define ZIG_R 3.442619855899	/* start of the tail */
+
+int32_t zig_k[128];		/* bound of the fast path of a layer */
+double zig_w[128];		/* value of one unit of a layer */
+double zig_f[128];		/* density at the layer boundaries */
+
+void init_ziggurat(void)
+{
+  const double m = 16777216.0;	/* 2^24 */
+  const double v = 9.91256303526217e-3; /* area of a layer */
+  double d,t,q;
+  int i;
+
+  d = t = ZIG_R;
+  q = v/exp(-0.5*d*d);
+  zig_k[0] = (int32_t)((d/q)*m);
+  zig_k[1] = 0;
+  zig_w[0] = q/m;
+  zig_w[127] = d/m;
+  zig_f[0] = 1.0;
+  zig_f[127] = exp(-0.5*d*d);
+  for (i = 126; i >= 1; i--) {
+    d = sqrt(-2.0*log(v/d + exp(-0.5*d*d)));
+    zig_k[i+1] = (int32_t)((d/t)*m);
+    t = d;
+    zig_f[i] = exp(-0.5*d*d);
+    zig_w[i] = d/m;
+  }
+}
+
+double zig_fix(simulation_parameters* p, int32_t hz, int iz)
+{
+  double x,y;
+  uint32_t u;
+
+  while (1) {
+    x = hz * zig_w[iz];
+    if (iz == 0) {		/* tail beyond ZIG_R */
+      do {
+	x = -log(rng_uniform(p)) / ZIG_R;
+	y = -log(rng_uniform(p));
+      } while (y+y < x*x);
+      return (hz > 0) ? ZIG_R + x : -ZIG_R - x;
+    }
+				/* wedge */
+    if (zig_f[iz] + rng_uniform(p)*(zig_f[iz-1] - zig_f[iz]) 
+	< exp(-0.5*x*x)) return x;
+    u = rng_u32(p);
+    hz = (int32_t)u >> 7;
+    iz = u & 127;
+    if (abs(hz) < zig_k[iz]) return hz * zig_w[iz];
+  }
+}
+
+/* ================================================== */
+/*  n normal random numbers of variance var are       */
+/*  added to x[0] ... x[n-1]                          */
+/* ================================================== */
+
+void gaussian_fill(simulation_parameters* p, double* x, int n, double var)
+{
+  double sigma;
+  uint32_t u;
+  int32_t hz;
+  int i,iz;
+
+  sigma = sqrt(var);
+  for (i = 0; i <= n-1; i++) {
+    u = rng_u32(p);
+    hz = (int32_t)u >> 7;
+    iz = u & 127;
+    if (abs(hz) < zig_k[iz]) x[i] += sigma * (hz * zig_w[iz]);
+    else x[i] += sigma * zig_fix(p,hz,iz);
+  }
+}
+
+/* ================================================== */
+/*  Random number stream of a worker                  */
+/*  With RNG_PHILOX every frame has its own stream    */
+/*  (init_frame_rng). With RNG_DRAND48, the           */
+/*  stream of worker k is that of srand48(seed)       */
+/*  advanced by k*2^40 numbers, so that the streams   */
+/*  of the workers do not overlap. The jump is done   */
+/*  on the generator x' = a x + c (mod 2^48) of       */
+/*  drand48 by squaring the map (a,c).                */
+/* ================================================== */
+
+void init_rng(simulation_parameters* p, int k)
+{
+  const uint64_t mask = ((uint64_t)1 << 48) - 1;
+  uint64_t x,a,c,ja,jc;
+  int i;
+
+  x = (((uint64_t)(unsigned int)p->seed << 16) | 0x330E) & mask;
+  a = 0x5DEECE66DULL;		/* map of one step */
+  c = 0xB;
+  for (i = 0; i <= 39; i++) {	/* map of 2^40 steps */
+    c = (a * c + c) & mask;
+    a = (a * a) & mask;
+  }
+  ja = 1;			/* map of k*2^40 steps */
+  jc = 0;
+  for (i = 0; i <= k-1; i++) {
+    jc = (a * jc + c) & mask;
+    ja = (a * ja) & mask;
+  }
+  x = (ja * x + jc) & mask;
+  p->rng[0] = x & 0xFFFF;
+  p->rng[1] = (x >> 16) & 0xFFFF;
+  p->rng[2] = (x >> 32) & 0xFFFF;
+  p->nrnd_sw = 0;
+
+  if ((p->rng_buf = (uint32_t*)aligned_alloc(SIMD_BYTES,
+					     sizeof(uint32_t)*RNG_WORDS)) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+  p->rng_pos = RNG_WORDS;	/* filled at the first use */
+}
+
+/* ================================================== */
+/*  Stream of frame number frame at the SNR p->snr    */
+/*  (RNG_PHILOX); the noise (and the information bits */
+/*  of sawgniterative) of a frame is a function of    */
+/*  the seed, the SNR and the frame number alone.     */
+/* ================================================== */
+
+void init_frame_rng(simulation_parameters* p, long long frame)
+{
+  p->rng_key[0] = (uint32_t)p->seed;
+  p->rng_key[1] = (uint32_t)llround(p->snr * 1e6);
+  p->rng_ctr[0] = p->rng_ctr[1] = 0;
+  p->rng_ctr[2] = (uint32_t)frame;
+  p->rng_ctr[3] = (uint32_t)((unsigned long long)frame >> 32);
+  p->rng_pos = RNG_WORDS;
+}
+
 /* ================================================== */
 /*  A normal Gaussian noise generator                 */
 /* ================================================== */
 
-double nrnd(double var)
+double nrnd(simulation_parameters* p, double var)
 {
-  static int sw = 0;
-  static double r1, r2, s;
+  double r1, s;
 
-  if (sw == 0) {
-    sw = 1;
+  if (p->nrnd_sw == 0) {
+    p->nrnd_sw = 1;
     do {
 
-      r1 = 2 * drand48() - 1;
-      r2 = 2 * drand48() - 1;
+      r1 = 2 * erand48(p->rng) - 1;
+      p->nrnd_r2 = 2 * erand48(p->rng) - 1;
 
-      s = r1 * r1 + r2 * r2;
+      s = r1 * r1 + p->nrnd_r2 * p->nrnd_r2;
     } while (s > 1 || s == 0);
-    s = sqrt(-2 * log(s) / s);
+    p->nrnd_s = s = sqrt(-2 * log(s) / s);
     return r1 * s * sqrt(var);
   } else {
-    sw = 0;
-    return r2 * s * sqrt(var);
+    p->nrnd_sw = 0;
+    return p->nrnd_r2 * p->nrnd_s * sqrt(var);
   }
 }
 
@@ -179,29 +848,56 @@ double nrnd(double var)
 /*  The function shows the contents in a sparce_matrix*/
 /* ================================================== */
 
-void print_parameter(sparce_matrix* s)
+void print_parameter(sparce_matrix* s, simulation_parameters* param)
 {
-  int m,i;
-  item* p;
+  int m,e;
   for (m = 0; m <= s->M-1; m++) {
-    p = (s->start_row_list[m]).right;
-    for (i = 1; i <= s->num_ones_in_row[m]; i++) {
+    for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++) {
       printf("\t(%d,%d:r0=%f,r1=%f) ",
-	     p->m, p->n,p->r0,p->r1);
-      p = p->right;
+	     m, s->edge_col[e],param->ws64.r0[e],param->ws64.r1[e]);
     }
     printf("\n");
 
-    p = (s->start_row_list[m]).right;
-    for (i = 1; i <= s->num_ones_in_row[m]; i++) {
+    for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++) {
       printf("\t(%d,%d:q0=%f,q1=%f) ",
-	     p->m, p->n,p->q0,p->q1);
-      p = p->right;
+	     m, s->edge_col[e],param->ws64.q0[e],param->ws64.q1[e]);
     }
     printf("\n\n");
   }
 }
 
+/* ================================================== */
+/*  The function sorts num nodes by degree (stable)   */
+/*  and returns the node order and the start of each  */
+/*  group of equal degree (group[num_groups] = num).  */
+/* ================================================== */
+
+void group_by_degree(int num, int* degree, int** order,
+		     int* num_groups, int** group)
+{
+  int i,d,max;
+  int* count;
+
+  max = 0;
+  for (i = 0; i <= num-1; i++) if (degree[i] > max) max = degree[i];
+
+  if (((count = (int*)calloc(max+2,sizeof(int))) == NULL)
+      || ((*order = (int*)malloc(sizeof(int)*num)) == NULL)
+      || ((*group = (int*)malloc(sizeof(int)*(max+2))) == NULL)) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+  for (i = 0; i <= num-1; i++) count[degree[i]+1]++;
+  *num_groups = 0;
+  for (d = 0; d <= max; d++) {
+    if (count[d+1] > 0) (*group)[(*num_groups)++] = count[d];
+    count[d+1] += count[d];
+  }
+  (*group)[*num_groups] = num;
+  for (i = 0; i <= num-1; i++) (*order)[count[degree[i]]++] = i;
+  free(count);
+}
+
 /* ================================================== */
 /*  The function reads spmat_file and sets the        */
 /*  sparce_matrix data structure.                     */
@@ -248,12 +944,9 @@ parity_check_matrix
 void read_spmat_file(FILE* fp, sparce_matrix* a)
 {
   int i,j;
-  int n,m;
-  char buf[128];
-  item *new_item, *last_item;
-  item* p;
-  item* q;
+  int n,m,e;
   int tmp;
+  int* fill;
     
   fscanf(fp,"%d %d\n",&(a->N),&(a->M));	/* reading N and M */
   fscanf(fp,"%d %d\n",&(a->biggest_num_ones_row),&(a->biggest_num_ones_col));
@@ -270,257 +963,414 @@ void read_spmat_file(FILE* fp, sparce_matrix* a)
     exit(-1);
   }
 
-  if ((a->start_col_list = (item*)malloc(sizeof(item)*(a->N))) == NULL) {
+  if ((a->row_start = (int*)malloc(sizeof(int)*(a->M+1))) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+
+  if ((a->col_start = (int*)malloc(sizeof(int)*(a->N+1))) == NULL) {
     fprintf(stderr,"Can't allocate memory\n");
     exit(-1);
   }
 
-  if ((a->start_row_list = (item*)malloc(sizeof(item)*(a->M))) == NULL) {
+  if ((fill = (int*)malloc(sizeof(int)*(a->N))) == NULL) {
     fprintf(stderr,"Can't allocate memory\n");
     exit(-1);
   }
 
+  a->row_start[0] = 0;
   for (i = 0; i <= a->M-1; i++) {
     fscanf(fp,"%d",&(a->num_ones_in_row[i]));
+    a->row_start[i+1] = a->row_start[i] + a->num_ones_in_row[i];
   }
   for (i = 0; i <= a->N-1; i++) {
     fscanf(fp,"%d",&(a->num_ones_in_col[i]));
-    a->start_col_list[i].down = NULL; /* This line is appended.  */
+    fill[i] = 0;
   }
+  a->num_edges = a->row_start[a->M];
 
-				/* making row links */
-  for (i = 0; i <= a->M-1; i++) {
-				/* processing i-th row */
-    last_item = &(a->start_row_list[i]);
-    for (j = 0; j <= a->num_ones_in_row[i]-1; j++) {
-      fscanf(fp,"%d",&tmp);
-      tmp--;
-				/* making new item */
-      if ((new_item = (item*)malloc(sizeof(item))) == NULL) {
-	fprintf(stderr,"Can't allocate memory\n");
-	exit(-1);
-      }
-      new_item->m = i;
-      new_item->n = tmp;
-      new_item->right = NULL;
-      new_item->down = NULL;
-      last_item->right = new_item;
-      last_item = new_item;
+  if ((a->edge_col = (int*)malloc(sizeof(int)*a->num_edges)) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+
+  if ((a->col_edge = (int*)malloc(sizeof(int)*a->num_edges)) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+
+  if ((a->edge_row = (int*)malloc(sizeof(int)*a->num_edges)) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+  for (m = 0; m <= a->M-1; m++) {
+    for (e = a->row_start[m]; e <= a->row_start[m+1]-1; e++) 
+      a->edge_row[e] = m;
+  }
+
+				/* reading rows (edges in row-major order) */
+  for (e = 0; e <= a->num_edges-1; e++) {
+    fscanf(fp,"%d",&tmp);
+    tmp--;
+    if ((tmp < 0) || (tmp >= a->N)) {
+      fprintf(stderr,"Illegal column number %d in spmat file\n",tmp+1);
+      exit(-1);
     }
+    a->edge_col[e] = tmp;
+    fill[tmp]++;
+  }
+				/* making column index */
+  a->col_start[0] = 0;
+  for (n = 0; n <= a->N-1; n++) {
+    if (fill[n] != a->num_ones_in_col[n]) {
+      fprintf(stderr,"num_ones_in_col of %d-th column is inconsistent\n",n);
+      exit(-1);
+    }
+    a->col_start[n+1] = a->col_start[n] + fill[n];
+    fill[n] = a->col_start[n];
   }
-				/* making column links */
   for (m = 0; m <= a->M-1; m++) {
-    p = (a->start_row_list[m]).right;
-    for (i = 0; i <= a->num_ones_in_row[m]-1; i++) {
-      q = &(a->start_col_list[p->n]);
-      while(q->down != NULL) {
-	q = q->down;
-      }
-      q->down = p; 
-      p = p->right;
+    for (j = a->row_start[m]; j <= a->row_start[m+1]-1; j++) {
+      a->col_edge[fill[a->edge_col[j]]++] = j;
     }
   }
+  free(fill);
+
+  if ((a->col_row = (int*)malloc(sizeof(int)*a->num_edges)) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+  for (e = 0; e <= a->num_edges-1; e++)
+    a->col_row[e] = a->edge_row[a->col_edge[e]];
+
+				/* grouping rows and columns by degree */
+  group_by_degree(a->M, a->num_ones_in_row, &(a->row_order),
+		  &(a->num_row_groups), &(a->row_group));
+  group_by_degree(a->N, a->num_ones_in_col, &(a->col_order),
+		  &(a->num_col_groups), &(a->col_group));
 }
 
 /* ================================================== */
-/*  AWGN channel                                      */
+/*  Layers of the layered schedule                    */
+/*  Without a layer file every row is a layer of its  */
+/*  own (rows in the order of H). A layer file has    */
+/*  the form                                          */
+/*    L                  (number of layers)           */
+/*    k_1 k_2 ... k_L    (number of rows in a layer)  */
+/*    rows of layer 1, rows of layer 2, ...           */
+/*  with row numbers 1..M as in spmat files. Every    */
+/*  row appears once, and the rows of a layer do not  */
+/*  share a column, so that they can be updated from  */
+/*  the same a posteriori values.                     */
 /* ================================================== */
 
-void awgn_channel(sparce_matrix* s, simulation_parameters* param)
+void init_layers(sparce_matrix* s, simulation_parameters* param)
 {
-  int i;
-  for (i = 0; i <= param->N-1; i++) {
-    param->rword[i] = 1.0 + nrnd(param->var);
+  FILE* fp;
+  int i,k,m,e,tmp;
+  int* mark;
+
+  if (((param->layer_row = (int*)malloc(sizeof(int)*s->M)) == NULL)
+      || ((mark = (int*)malloc(sizeof(int)*s->N)) == NULL)) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+  if (param->layer_file == NULL) {
+    param->num_layers = s->M;
+    if ((param->layer_start = (int*)malloc(sizeof(int)*(s->M+1))) == NULL) {
+      fprintf(stderr,"Can't allocate memory\n");
+      exit(-1);
+    }
+    for (m = 0; m <= s->M; m++) param->layer_start[m] = m;
+    for (m = 0; m <= s->M-1; m++) param->layer_row[m] = m;
+    free(mark);
+    return;
+  }
+
+  if ((fp = fopen(param->layer_file,"r")) == NULL) {
+    fprintf(stderr,"Can't open %s.\n",param->layer_file);
+    exit(-1);
+  }
+  if ((fscanf(fp,"%d",&(param->num_layers)) != 1) 
+      || (param->num_layers < 1) || (param->num_layers > s->M)) {
+    fprintf(stderr,"Illegal number of layers in %s\n",param->layer_file);
+    exit(-1);
+  }
+  if ((param->layer_start 
+       = (int*)malloc(sizeof(int)*(param->num_layers+1))) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+  param->layer_start[0] = 0;
+  for (k = 0; k <= param->num_layers-1; k++) {
+    if ((fscanf(fp,"%d",&tmp) != 1) || (tmp < 1)) {
+      fprintf(stderr,"Illegal size of %d-th layer\n",k+1);
+      exit(-1);
+    }
+    param->layer_start[k+1] = param->layer_start[k] + tmp;
+  }
+  if (param->layer_start[param->num_layers] != s->M) {
+    fprintf(stderr,"Layers should contain %d rows in total\n",s->M);
+    exit(-1);
+  }
+				/* reading rows; mark[] holds the */
+				/* layer that last used a column and */
+				/* the row marks (-2) of used rows */
+  for (i = 0; i <= s->N-1; i++) mark[i] = -1;
+  for (i = 0; i <= s->M-1; i++) param->layer_row[i] = -1;
+  for (k = 0; k <= param->num_layers-1; k++) {
+    for (i = param->layer_start[k]; i <= param->layer_start[k+1]-1; i++) {
+      if ((fscanf(fp,"%d",&tmp) != 1) || (tmp < 1) || (tmp > s->M)) {
+	fprintf(stderr,"Illegal row number in %s\n",param->layer_file);
+	exit(-1);
+      }
+      m = tmp-1;
+      param->layer_row[i] = m;
+      for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++) {
+	if (mark[s->edge_col[e]] == k) {
+	  fprintf(stderr,"Rows of %d-th layer share column %d\n",
+		  k+1,s->edge_col[e]+1);
+	  exit(-1);
+	}
+	mark[s->edge_col[e]] = k;
+      }
+    }
+  }
+  fclose(fp);
+				/* every row exactly once */
+  free(mark);
+  if ((mark = (int*)calloc(s->M,sizeof(int))) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
   }
+  for (i = 0; i <= s->M-1; i++) {
+    if (mark[param->layer_row[i]]++ != 0) {
+      fprintf(stderr,"Row %d appears twice in %s\n",
+	      param->layer_row[i]+1,param->layer_file);
+      exit(-1);
+    }
+  }
+  free(mark);
 }
 
 /* ================================================== */
-/*  The BCJR algorithm                                */
+/*  Importance sampling (-is)                         */
+/*  The log of f(n)/g(n) for the noise n of one bit,  */
+/*  n > 0 toward the correct sign; f is the density   */
+/*  N(0,var) of the channel and g the biased density  */
+/*  of the samples: N(-B,var) for IS_SHIFT and        */
+/*  N(0,B*var) for IS_SCALE. The weight of a frame is */
+/*  the product over its bits.                        */
 /* ================================================== */
 
-void bcjr(sparce_matrix* s, simulation_parameters* p,int row_num)
+double is_log_ratio(simulation_parameters* p, double n)
 {
-  int i,m;
-  item* pos;
-  double t0,t1,sum;
+  double b = p->is_bias;
 
-				/* copy */
-  /*
-
-    likelihood function 
-    exp(y x/ var)  for x = +1,-1
-    y: received symbol
-    x: code symbol
+  if (p->is_method == IS_SHIFT) return b * (2.0 * n + b) / (2.0 * p->var);
+  return 0.5 * log(b) - n * n * (1.0 - 1.0 / b) / (2.0 * p->var);
+}
 
-  */
+/* ================================================== */
+/*  AWGN channel                                      */
+/* ================================================== */
 
-  pos = (s->start_row_list[row_num]).right;
-  for (i = 0; i <= s->num_ones_in_row[row_num]-1; i++) {
-    p->bcjr_tmp0[i] = exp(p->rword[pos->n] / p->var);
-    p->bcjr_tmp1[i] = exp(-p->rword[pos->n] / p->var);
-    p->bcjr_tmp_q0[i] = pos->q0;
-    p->bcjr_tmp_q1[i] = pos->q1;
-    pos = pos->right;
+void awgn_channel(sparce_matrix* s, simulation_parameters* param)
+{
+  int i;
+  double mean,var,logw;
+				/* biased noise (-is) */
+  mean = 1.0;
+  var = param->var;
+  if (param->is_method == IS_SHIFT) mean -= param->is_bias;
+  if (param->is_method == IS_SCALE) var *= param->is_bias;
+
+  if (param->rng_type == RNG_PHILOX) {
+    for (i = 0; i <= param->N-1; i++) param->rword[i] = mean;
+    gaussian_fill(param,param->rword,param->N,var);
   }
-				/* forward computation */
-  p->bcjr_for0[0] = 1.0;
-  p->bcjr_for1[0] = 0.0;
-
-  for (i = 1; i <= s->num_ones_in_row[row_num]; i++) {
-    t0  =  p->bcjr_tmp0[i-1] * p->bcjr_tmp_q0[i-1] * p->bcjr_for0[i-1]
-      + p->bcjr_tmp1[i-1] * p->bcjr_tmp_q1[i-1] * p->bcjr_for1[i-1];
-
-    t1  = p->bcjr_tmp1[i-1] * p->bcjr_tmp_q1[i-1] * p->bcjr_for0[i-1]
-      + p->bcjr_tmp0[i-1] * p->bcjr_tmp_q0[i-1] * p->bcjr_for1[i-1];
-
-				/* scaling */
-    sum = t0 + t1;
-    p->bcjr_for0[i] = t0/sum;
-    p->bcjr_for1[i] = t1/sum;
+  else {
+    for (i = 0; i <= param->N-1; i++) {
+      param->rword[i] = mean + nrnd(param,var);
+    }
   }
-  p->bcjr_for1[s->num_ones_in_row[row_num]] = 0.0;
-
-				/* backward computation */
-
-  p->bcjr_back0[s->num_ones_in_row[row_num]] = 1.0;
-  p->bcjr_back1[s->num_ones_in_row[row_num]] = 0.0;
+  if (param->is_method == IS_OFF) return;
+  logw = 0.0;
+  for (i = 0; i <= param->N-1; i++) 
+    logw += is_log_ratio(param,param->rword[i] - 1.0);
+  param->is_weight = exp(logw);
+}
 
-  for (i = s->num_ones_in_row[row_num]-1; i >= 0; i--) {
-    t0 = p->bcjr_tmp0[i] * p->bcjr_tmp_q0[i] * p->bcjr_back0[i+1]
-      + p->bcjr_tmp1[i] * p->bcjr_tmp_q1[i] * p->bcjr_back1[i+1];
+/* ================================================== */
+/*  The decision of a column flips; the syndrome bits */
+/*  of its rows toggle and the number of unsatisfied  */
+/*  checks follows.                                   */
+/* ================================================== */
 
-    t1 = p->bcjr_tmp1[i] * p->bcjr_tmp_q1[i] * p->bcjr_back0[i+1]
-      + p->bcjr_tmp0[i] * p->bcjr_tmp_q0[i] * p->bcjr_back1[i+1];
+void flip_decision(sparce_matrix* s, simulation_parameters* p, int col_num)
+{
+  int i,m;
 
-				/* scaling */
-    sum = t0 + t1;
-    p->bcjr_back0[i] = t0/sum;
-    p->bcjr_back1[i] = t1/sum;
+  p->tmp_decision[col_num] ^= 1;
+  if (p->syndrome == NULL) return; /* split_syndrome follows */
+  for (i = s->col_start[col_num]; i <= s->col_start[col_num+1]-1; i++) {
+    m = s->col_row[i];
+    p->syndrome[m] ^= 1;
+    p->unsatisfied += 2*p->syndrome[m] - 1;
   }
-  p->bcjr_back1[0] = 0.0;
-
-				/* update for r0 and r1 */
+}
 
-  pos = (s->start_row_list[row_num]).right;
-  for (i = 0; i <= s->num_ones_in_row[row_num]-1; i++) {
+/* ================================================== */
+/*  Temporary decision and error count for a bit      */
+/* ================================================== */
 
-				/* extrinsic values */
-    pos->r0 = p->bcjr_for0[i] * p->bcjr_back0[i+1]
-      + p->bcjr_for1[i] * p->bcjr_back1[i+1];
-    
-    pos->r1= p->bcjr_for0[i] * p->bcjr_back1[i+1]
-      + p->bcjr_for1[i] * p->bcjr_back0[i+1];
-    pos = pos->right;
-  }
+void bit_decision(sparce_matrix* s, simulation_parameters* p, 
+		  int col_num, int decision)
+{
+  if (p->tmp_decision[col_num] != decision) flip_decision(s,p,col_num);
+				/* error count */
+  p->error_weight_in_word += decision;
 }
 
 /* ================================================== */
-/*  Updown algorith for updating q0 and q1            */
+/*  Reference bit of a column for the error count of  */
+/*  the lane kernels: the transmitted bit, or -1 if   */
+/*  the column is not counted (see bit_decision)      */
 /* ================================================== */
 
-void updown(sparce_matrix* s, simulation_parameters* p,int col_num)
+int reference_bit(sparce_matrix* s, simulation_parameters* p, int col_num)
 {
-  int i,n;
-  item* pos;
-  double t0, t1;
-  double sum;
-				/* copy */
-  pos = (s->start_col_list[col_num]).down;
-  for (i = 0; i <= s->num_ones_in_col[col_num]-1; i++) {
-    p->ud_tmp0[i] = pos->r0;
-    p->ud_tmp1[i] = pos->r1;
-    pos = pos->down;
-  }
-				/* downward computation */
-  p->ud_downward0[0] = 1.0;
-  p->ud_downward1[0] = 1.0;
-  for (i = 1; i <= s->num_ones_in_col[col_num]; i++) {
-    t0 = p->ud_tmp0[i-1] * p->ud_downward0[i-1];
-    t1 = p->ud_tmp1[i-1] * p->ud_downward1[i-1];
-    sum = t0 + t1;    
-    p->ud_downward0[i] = t0/sum;
-    p->ud_downward1[i] = t1/sum;
-  }
-				/* upward computation */
-  p->ud_upward0[s->num_ones_in_col[col_num]] = 1.0;
-  p->ud_upward1[s->num_ones_in_col[col_num]] = 1.0;
-  for (i = s->num_ones_in_col[col_num]-1; i >= 0; i--) {
-    t0 = p->ud_tmp0[i] * p->ud_upward0[i+1];
-    t1 = p->ud_tmp1[i] * p->ud_upward1[i+1];
-    sum = t0 + t1;
-    p->ud_upward0[i] = t0/sum;
-    p->ud_upward1[i] = t1/sum;
-  }
-
-				/* update for q0 and q1 */
-  pos = (s->start_col_list[col_num]).down;
-  for (i = 0; i <= s->num_ones_in_col[col_num]-1; i++) {
-    t0 = p->ud_downward0[i] * p->ud_upward0[i+1];
-    t1 = p->ud_downward1[i] * p->ud_upward1[i+1];
-
-				/* scaling */
-    sum = t0 + t1;
-    pos->q0 = t0/sum;
-    pos->q1 = t1/sum;
-
-    if (pos->q0 == 0) {
-      //      printf("caution t0  %16.12f\n",pos->q0);
-      pos->q0 = 1E-8;
-      pos->q1 = 1.0 - 1E-8;
-    }
-    if (pos->q1 == 0) {
-      //      printf("caution t1  %16.12f\n",pos->q1);
-      pos->q1 = 1E-8;
-      pos->q0 = 1.0 - 1E-8;
-    }
-
-    pos = pos->down;
-  }
-				/* update pseudo probability for each bit */
-  
-  t0 = exp(p->rword[col_num] / p->var) * p->ud_upward0[0];
-  t1 = exp(-p->rword[col_num] / p->var) * p->ud_upward1[0];
+  return 0;			/* all-zero word */
+}
 
-				/* scaling */
+/* ================================================== */
+/*  The all-zero decision and its syndrome; called at */
+/*  the start of every decoding                       */
+/* ================================================== */
 
-  sum = t0 + t1;
-  p->tmp_q0[col_num] = t0/sum;
-  p->tmp_q1[col_num] = t1/sum;
+void init_syndrome(sparce_matrix* s, simulation_parameters* p)
+{
+  memset(p->tmp_decision,0,sizeof(int)*s->N);
+  memset(p->syndrome,0,sizeof(int)*s->M);
+  p->unsatisfied = 0;
+  p->abandoned = 0;
+  p->trace_iteration = 0;
+}
 
-				/* temporary decision for each bit*/
+/* ================================================== */
+/*  Failure predictor for early abandonment; called   */
+/*  after a failed parity check of iteration i.       */
+/*  return value = 0: continue decoding               */
+/*  return value = 1: give up the frame               */
+/*  The number of unsatisfied checks has stopped      */
+/*  improving (no new minimum for abandon_window      */
+/*  iterations) or keeps oscillating (its direction   */
+/*  changed at each of the last abandon_window).      */
+/* ================================================== */
 
+int abandon_frame(simulation_parameters* p, int i)
+{
+  int u,dir;
+
+  if (p->abandon_window == 0) return 0;
+  u = p->unsatisfied;
+  if (i == 1) {
+    p->ab_best = p->ab_prev = u;
+    p->ab_since = p->ab_dir = p->ab_swings = 0;
+    return 0;
+  }
+  if (u < p->ab_best) {
+    p->ab_best = u;
+    p->ab_since = 0;
+  }
+  else p->ab_since++;
+  dir = (u > p->ab_prev) - (u < p->ab_prev);
+  p->ab_swings = ((dir != 0) && (dir == -p->ab_dir)) ? p->ab_swings+1 : 0;
+  p->ab_dir = dir;
+  p->ab_prev = u;
+
+  if ((p->ab_since >= p->abandon_window)
+      || (p->ab_swings >= p->abandon_window)) {
+    p->abandoned = 1;
+    p->abandoned_blocks++;
+    p->abandoned_iterations += p->max_iteration - i;
+    return 1;
+  }
+  return 0;
+}
 
-  if (p->tmp_q1[col_num] > p->tmp_q0[col_num]) 
-    p->tmp_decision[col_num] = 1;
-  else 
-    p->tmp_decision[col_num] = 0;
+/* ================================================== */
+/*  Trace of an iteration of a replayed frame; called */
+/*  once per iteration by parity_check               */
+/* ================================================== */
 
-				/* error count */
-  p->error_weight_in_word += p->tmp_decision[col_num];
+void trace_iteration(simulation_parameters* p)
+{
+  p->trace_iteration++;
+  printf("#replay: itr %d unsatisfied %d ebits %d\n",
+	 p->trace_iteration,p->unsatisfied,p->error_weight_in_word);
 }
 
 /* ================================================== */
 /*  parity check function                             */
 /*  return value = 0 : tmp_decision is a codeword     */
 /*  return value = 1 : tmp_decision is not a codeword */
+/*  The syndrome follows every flip of tmp_decision   */
+/*  (flip_decision), so no pass over H is needed.     */
 /* ================================================== */
 
 int parity_check(sparce_matrix* s, simulation_parameters* p)
 {
-  int m,i;
-  item* pos;
-  int parity;
+  if (p->trace) trace_iteration(p);
+  return (p->unsatisfied != 0);
+}
 
-  for (m = 0; m <= s->M-1; m++) {
-    parity = 0;
-    pos = (s->start_row_list[m]).right;
-    for (i = 0; i <= s->num_ones_in_row[m]-1; i++) {
-      parity = (parity + p->tmp_decision[pos->n]) % 2;
-      pos = pos->right;
-    }
-    if (parity == 1) return 1;
+/* ================================================== */
+/*  Estimate of pb (bits = 1) or pB (bits = 0) and    */
+/*  the variance of the estimate, from the counts of  */
+/*  the frames or, with weighted = 1, from the        */
+/*  weights of importance sampling                    */
+/* ================================================== */
+
+#define CI_Z 1.959964		/* 95% two-sided normal quantile */
+#define IS_CI_WIDTH 0.2		/* default -ci of -is */
+#define MAX_OPTIONS (FILENAME_MAX + 1024) /* text of run_options */
+
+void error_rate(simulation_parameters* p, int bits, int weighted,
+		double* mean, double* var)
+{
+  double n,per;
+
+  n = p->total_blocks;
+  per = bits ? (double)p->total_bits / p->total_blocks : 1.0;
+  if (weighted) {
+    *mean = (bits ? p->is_bits : p->is_blocks) / (n * per);
+    *var = ((bits ? p->is_bits2 : p->is_blocks2) / (n * per * per) 
+	    - *mean * *mean) / n;
   }
-  return 0;
+  else if (bits) {
+    *mean = p->error_bits / (n * per);
+    *var = (p->error_bits2 / (n * per * per) - *mean * *mean) / n;
+  }
+  else {
+    *mean = p->error_blocks / n;
+    *var = *mean * (1.0 - *mean) / n;
+  }
+  if (*var < 0.0) *var = 0.0;	/* rounding */
+}
+
+/* 95% confidence interval of the counted pb or pB (normal */
+/* approximation over frames) */
+
+void confidence_interval(simulation_parameters* p, int bits, 
+			 double* lo, double* hi)
+{
+  double mean,var;
+
+  error_rate(p,bits,0,&mean,&var);
+  *lo = mean - CI_Z * sqrt(var);
+  if (*lo < 0.0) *lo = 0.0;
+  *hi = mean + CI_Z * sqrt(var);
 }
 
 /* ================================================== */
@@ -529,11 +1379,16 @@ int parity_check(sparce_matrix* s, simulation_parameters* p)
 
 void print_results(FILE* out,char* file, simulation_parameters* param)
 {
+  double lb,hb,lB,hB;
+
+  confidence_interval(param,1,&lb,&hb);
+  confidence_interval(param,0,&lB,&hB);
 				/* print simulation results */
   if (param->display == 0)
     fprintf(out,
-	    "#snr pb pB var #eblks #blks #ebits #bits aveitr seed maxitr\n");
-  fprintf(out,"%16.12e %16.12e %16.12e %16.12e %d %d %d %d %f %d %d %d %d %s %d %d\n",
+	    "#snr pb pB var #eblks #blks #ebits #bits aveitr seed maxitr"
+	    " N M file stop #err pb_lo pb_hi pB_lo pB_hi\n");
+  fprintf(out,"%16.12e %16.12e %16.12e %16.12e %lld %lld %lld %lld %f %d %d %d %d %s %d %d %16.12e %16.12e %16.12e %16.12e\n",
 	  param->snr,
 	  (double)param->error_bits/param->total_bits,
 	  (double)param->error_blocks/param->total_blocks,
@@ -549,196 +1404,2915 @@ void print_results(FILE* out,char* file, simulation_parameters* param)
 	  param->M,
 	  file,
 	  param->stop,
-	  param->stop_err
+	  param->stop_err,
+	  lb,hb,lB,hB
 	  );
 }
 
 /* ================================================== */
-/*  sum product decoder                               */
-/*  return value = 0: success                         */
-/*  return value = 1: failure                         */
+/*  precision report for PREC_COMPARE                 */
 /* ================================================== */
 
-int sum_product_decoder(sparce_matrix* s, simulation_parameters* param)
+void print_precision_report(FILE* out, simulation_parameters* param)
 {
-  int i,n,m;
-  item* pos;
-  int parity;
-				/* initialize q0 and q1 to be 1.0 */
-  for (m = 0; m <= s->M-1; m++) {
-    pos = (s->start_row_list[m]).right;
-    for (i = 1; i <= s->num_ones_in_row[m]; i++) {
-      pos->q0 = 1.0;
-      pos->q1 = 1.0;
-      pos = pos->right;
-    }
-  }
-				/* iterative decoding */
-  for (i = 1; i <= param->max_iteration; i++) {
-    param->error_weight_in_word = 0;
-    param->num_iteration++;
-				/* row processing */
+  fprintf(out,"#float: pb pB #ebits #eblks aveitr #dblks #dbits\n");
+  fprintf(out,"#float: %16.12e %16.12e %lld %lld %f %lld %lld\n",
+	  (double)param->cmp_error_bits/param->total_bits,
+	  (double)param->cmp_error_blocks/param->total_blocks,
+	  param->cmp_error_bits,
+	  param->cmp_error_blocks,
+	  (double)param->cmp_num_iteration/param->total_blocks,
+	  param->cmp_differ_blocks,
+	  param->cmp_differ_bits
+	  );
+}
 
-    for (m = 0; m <= s->M-1; m++) bcjr(s,param,m); 
+/* ================================================== */
+/*  report of the failure predictor (-abandon)        */
+/* ================================================== */
 
-				/* column processing */
-    for (n = 0; n <= s->N-1; n++) updown(s,param,n);
+void print_abandon_report(FILE* out, simulation_parameters* param)
+{
+  fprintf(out,"#abandon: #ablks pA #saveditr saveditr\n");
+  fprintf(out,"#abandon: %lld %16.12e %lld %f\n",
+	  param->abandoned_blocks,
+	  (double)param->abandoned_blocks/param->total_blocks,
+	  param->abandoned_iterations,
+	  (double)param->abandoned_iterations/param->total_blocks
+	  );
+}
 
-				/* parity check for temporary decision */
-    parity = parity_check(s,param); 
+/* ================================================== */
+/*  report of importance sampling (-is)               */
+/*  pb and pB are the means of the weighted counts    */
+/*  per bit and per block; var is the variance of the */
+/*  estimate and re = sqrt(var(pB))/pB.               */
+/* ================================================== */
 
-    if (parity == 0) return 0;	/* successful decoding */
-  }
-  return 1;			/* decoding failure */
+void print_is_report(FILE* out, simulation_parameters* param)
+{
+  double pb,pB,vb,vB;
+
+  error_rate(param,1,1,&pb,&vb);
+  error_rate(param,0,1,&pB,&vB);
+  fprintf(out,"#is: method bias pb pB var(pb) var(pB) re(pB)\n");
+  fprintf(out,"#is: %s %f %16.12e %16.12e %16.12e %16.12e %f\n",
+	  (param->is_method == IS_SHIFT) ? "shift" : "scale",
+	  param->is_bias,pb,pB,vb,vB,
+	  (pB > 0) ? sqrt(vB) / pB : 0.0
+	  );
 }
 
 /* ================================================== */
-/*  Initialization on simulation parameters           */
+/*  Intra-frame parallel decoding (-split)            */
+/*  The rows and the columns of a flooding iteration  */
+/*  are split into one range per thread, balanced by  */
+/*  the number of edges. The threads of a pool are    */
+/*  persistent; an iteration is the row phase, a      */
+/*  barrier, the column phase, a barrier and the      */
+/*  syndrome of the own rows. The caller of split_run */
+/*  is thread 0.                                      */
+/*  Each thread decodes through a view: a copy of the */
+/*  simulation_parameters that shares the messages    */
+/*  and tmp_decision of the frame but has its own     */
+/*  node work areas and error count. The view has no  */
+/*  syndrome, so the columns only record decisions;   */
+/*  the syndrome bits and the unsatisfied checks are  */
+/*  counted per range afterwards.                     */
 /* ================================================== */
 
-void init_simulation_param(sparce_matrix* s, simulation_parameters* param)
+typedef struct _SPLIT_SLOT
 {
-  param->N = s->N;
-  param->M = s->M;
-  param->total_blocks = 0;
-  param->error_blocks = 0;
-  param->total_bits = 0;
-  param->error_bits = 0;
-  param->num_iteration = 0;
+  _Alignas(CACHE_LINE) simulation_parameters view;
+  struct _SPLIT* pool;
+  int t;			/* thread number */
+  int row_begin, row_end;	/* rows row_order[row_begin] ... */
+  int col_begin, col_end;	/* columns col_order[col_begin] ... */
+  pthread_t thread;
+} split_slot;
+
+typedef struct _SPLIT
+{
+  int threads;			/* number of threads incl. the caller */
+  int command;			/* SPLIT_ITER64 or SPLIT_ITER32 */
+  sparce_matrix* s;
+  simulation_parameters* param;	/* the frame */
+  pthread_barrier_t barrier;
+  split_slot* slot;
+} split_pool;
 
-  if ((param->rword = (double*)malloc(sizeof(double)*param->N)) == NULL) {
-    fprintf(stderr,"Can't allocate memory\n");
-    exit(-1);
-  }
+void split_run(simulation_parameters* param, int command);
 
-  if ((param->bcjr_for0 
-       = (double*)malloc(sizeof(double)*(s->biggest_num_ones_row + 1))) 
-      == NULL) {
-    fprintf(stderr,"Can't allocate memory\n");
-    exit(-1);
+/* syndrome and unsatisfied checks of the rows of a slot */
+
+void split_syndrome(sparce_matrix* s, simulation_parameters* param,
+		    split_slot* sl)
+{
+  int k,m,e,bit;
+
+  sl->view.unsatisfied = 0;
+  for (k = sl->row_begin; k <= sl->row_end-1; k++) {
+    m = s->row_order[k];
+    bit = 0;
+    for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++) 
+      bit ^= param->tmp_decision[s->edge_col[e]];
+    param->syndrome[m] = bit;
+    sl->view.unsatisfied += bit;
   }
-  if ((param->bcjr_for1 
-       = (double*)malloc(sizeof(double)*(s->biggest_num_ones_row + 1))) 
-      == NULL) {
-    fprintf(stderr,"Can't allocate memory\n");
-    exit(-1);
+}
+
+/* ================================================== */
+/*  Floating point decoders                           */
+/*  FLOAT_DECODER(T,I,W) defines the sum-product      */
+/*  (BCJR and updown), box-plus and min-sum decoders  */
+/*  with messages of type T stored in p->ws##W. I is  */
+/*  the signed integer type of the same size as T     */
+/*  (lane masks). The math functions are type-generic */
+/*  (tgmath.h), so the float instance runs entirely   */
+/*  in single precision.                              */
+/*  decoder##W returns 0 on success, 1 on failure.    */
+/* ================================================== */
+
+#define FLOAT_DECODER(T,I,W)						\
+									\
+/* ================================================== */		\
+/*  The BCJR algorithm                                */		\
+/* ================================================== */		\
+									\
+void bcjr##W(sparce_matrix* s, simulation_parameters* p,int row_num)	\
+{									\
+  workspace##W* w = &p->ws##W;						\
+  int i,e;								\
+  T t0,t1,sum;								\
+									\
+				/* copy */				\
+  /*									\
+									\
+    likelihood function							\
+    exp(y x/ var)  for x = +1,-1					\
+    y: received symbol							\
+    x: code symbol							\
+									\
+  */									\
+									\
+  e = s->row_start[row_num];						\
+  for (i = 0; i <= s->num_ones_in_row[row_num]-1; i++, e++) {		\
+    w->bcjr_tmp0[i] = w->ch0[s->edge_col[e]];				\
+    w->bcjr_tmp1[i] = w->ch1[s->edge_col[e]];				\
+    w->bcjr_tmp_q0[i] = w->q0[e];					\
+    w->bcjr_tmp_q1[i] = w->q1[e];					\
+  }									\
+				/* forward computation */		\
+  w->bcjr_for0[0] = 1.0;						\
+  w->bcjr_for1[0] = 0.0;						\
+									\
+  for (i = 1; i <= s->num_ones_in_row[row_num]; i++) {			\
+    t0  =  w->bcjr_tmp0[i-1] * w->bcjr_tmp_q0[i-1] * w->bcjr_for0[i-1]	\
+      + w->bcjr_tmp1[i-1] * w->bcjr_tmp_q1[i-1] * w->bcjr_for1[i-1];	\
+									\
+    t1  = w->bcjr_tmp1[i-1] * w->bcjr_tmp_q1[i-1] * w->bcjr_for0[i-1]	\
+      + w->bcjr_tmp0[i-1] * w->bcjr_tmp_q0[i-1] * w->bcjr_for1[i-1];	\
+									\
+				/* scaling */				\
+    sum = t0 + t1;							\
+    w->bcjr_for0[i] = t0/sum;						\
+    w->bcjr_for1[i] = t1/sum;						\
+  }									\
+  w->bcjr_for1[s->num_ones_in_row[row_num]] = 0.0;			\
+									\
+				/* backward computation */		\
+									\
+  w->bcjr_back0[s->num_ones_in_row[row_num]] = 1.0;			\
+  w->bcjr_back1[s->num_ones_in_row[row_num]] = 0.0;			\
+									\
+  for (i = s->num_ones_in_row[row_num]-1; i >= 0; i--) {		\
+    t0 = w->bcjr_tmp0[i] * w->bcjr_tmp_q0[i] * w->bcjr_back0[i+1]	\
+      + w->bcjr_tmp1[i] * w->bcjr_tmp_q1[i] * w->bcjr_back1[i+1];	\
+									\
+    t1 = w->bcjr_tmp1[i] * w->bcjr_tmp_q1[i] * w->bcjr_back0[i+1]	\
+      + w->bcjr_tmp0[i] * w->bcjr_tmp_q0[i] * w->bcjr_back1[i+1];	\
+									\
+				/* scaling */				\
+    sum = t0 + t1;							\
+    w->bcjr_back0[i] = t0/sum;						\
+    w->bcjr_back1[i] = t1/sum;						\
+  }									\
+  w->bcjr_back1[0] = 0.0;						\
+									\
+				/* update for r0 and r1 */		\
+									\
+  e = s->row_start[row_num];						\
+  for (i = 0; i <= s->num_ones_in_row[row_num]-1; i++, e++) {		\
+									\
+				/* extrinsic values */			\
+    w->r0[e] = w->bcjr_for0[i] * w->bcjr_back0[i+1]			\
+      + w->bcjr_for1[i] * w->bcjr_back1[i+1];				\
+									\
+    w->r1[e] = w->bcjr_for0[i] * w->bcjr_back1[i+1]			\
+      + w->bcjr_for1[i] * w->bcjr_back0[i+1];				\
+  }									\
+}									\
+									\
+/* ================================================== */		\
+/*  Updown algorith for updating q0 and q1            */		\
+/* ================================================== */		\
+									\
+void updown##W(sparce_matrix* s, simulation_parameters* p,int col_num)	\
+{									\
+  workspace##W* w = &p->ws##W;						\
+  int i,e;								\
+  int* edge;								\
+  T t0, t1;								\
+  T sum;								\
+				/* copy */				\
+  edge = s->col_edge + s->col_start[col_num];				\
+  for (i = 0; i <= s->num_ones_in_col[col_num]-1; i++) {		\
+    w->ud_tmp0[i] = w->r0[edge[i]];					\
+    w->ud_tmp1[i] = w->r1[edge[i]];					\
+  }									\
+				/* downward computation */		\
+  w->ud_downward0[0] = 1.0;						\
+  w->ud_downward1[0] = 1.0;						\
+  for (i = 1; i <= s->num_ones_in_col[col_num]; i++) {			\
+    t0 = w->ud_tmp0[i-1] * w->ud_downward0[i-1];			\
+    t1 = w->ud_tmp1[i-1] * w->ud_downward1[i-1];			\
+    sum = t0 + t1;							\
+    w->ud_downward0[i] = t0/sum;					\
+    w->ud_downward1[i] = t1/sum;					\
+  }									\
+				/* upward computation */		\
+  w->ud_upward0[s->num_ones_in_col[col_num]] = 1.0;			\
+  w->ud_upward1[s->num_ones_in_col[col_num]] = 1.0;			\
+  for (i = s->num_ones_in_col[col_num]-1; i >= 0; i--) {		\
+    t0 = w->ud_tmp0[i] * w->ud_upward0[i+1];				\
+    t1 = w->ud_tmp1[i] * w->ud_upward1[i+1];				\
+    sum = t0 + t1;							\
+    w->ud_upward0[i] = t0/sum;						\
+    w->ud_upward1[i] = t1/sum;						\
+  }									\
+									\
+				/* update for q0 and q1 */		\
+  for (i = 0; i <= s->num_ones_in_col[col_num]-1; i++) {		\
+    e = edge[i];							\
+    t0 = w->ud_downward0[i] * w->ud_upward0[i+1];			\
+    t1 = w->ud_downward1[i] * w->ud_upward1[i+1];			\
+									\
+				/* scaling */				\
+    sum = t0 + t1;							\
+    w->q0[e] = t0/sum;							\
+    w->q1[e] = t1/sum;							\
+									\
+    if (w->q0[e] == 0) {						\
+      w->q0[e] = (T)1E-8;						\
+      w->q1[e] = (T)(1.0 - 1E-8);					\
+    }									\
+    if (w->q1[e] == 0) {						\
+      w->q1[e] = (T)1E-8;						\
+      w->q0[e] = (T)(1.0 - 1E-8);					\
+    }									\
+  }									\
+				/* update pseudo probability for each bit */ \
+									\
+  t0 = w->ch0[col_num] * w->ud_upward0[0];				\
+  t1 = w->ch1[col_num] * w->ud_upward1[0];				\
+									\
+				/* scaling */				\
+									\
+  sum = t0 + t1;							\
+  w->tmp_q0[col_num] = t0/sum;						\
+  w->tmp_q1[col_num] = t1/sum;						\
+									\
+				/* temporary decision for each bit*/	\
+									\
+  bit_decision(s,p,col_num,(w->tmp_q1[col_num] > w->tmp_q0[col_num]));	\
+}									\
+									\
+/* ================================================== */		\
+/*  phi(x) = -log(tanh(x/2)) for x >= 0               */		\
+/*  The box-plus sum of LLRs l_1,...,l_k is           */		\
+/*  (prod sign l_j) * phi(phi(|l_1|)+...+phi(|l_k|)). */		\
+/*  phi(0) = +inf and phi(+inf) = 0 are exact, so no  */		\
+/*  clamp is required.                                */		\
+/* ================================================== */		\
+									\
+T phi##W(T x)								\
+{									\
+  return log1p((T)2.0 / expm1(x));					\
+}									\
+									\
+/* ================================================== */		\
+/*  Check node update in the LLR domain (box-plus)    */		\
+/* ================================================== */		\
+									\
+void llr_check_node##W(sparce_matrix* s, simulation_parameters* p,int row_num) \
+{									\
+  workspace##W* w = &p->ws##W;						\
+  int i,e,d;								\
+  int sign;								\
+  T back,mag;								\
+									\
+  d = s->num_ones_in_row[row_num];					\
+  e = s->row_start[row_num];						\
+				/* forward computation */		\
+  sign = 0;								\
+  w->llr_for[0] = 0.0;							\
+  for (i = 0; i <= d-1; i++) {						\
+    w->llr_phi[i] = phi##W(fabs(w->lq[e+i]));				\
+    w->llr_for[i+1] = w->llr_for[i] + w->llr_phi[i];			\
+    sign ^= (w->lq[e+i] < 0);						\
+  }									\
+				/* backward computation and */		\
+				/* extrinsic values */			\
+  back = 0.0;								\
+  for (i = d-1; i >= 0; i--) {						\
+    mag = phi##W(w->llr_for[i] + back);					\
+    w->lr[e+i] = (sign ^ (w->lq[e+i] < 0)) ? -mag : mag;		\
+    back += w->llr_phi[i];						\
+  }									\
+}									\
+									\
+/* ================================================== */		\
+/*  Check node update of the min-sum family           */		\
+/*  Only the two smallest magnitudes and the parity   */		\
+/*  of the signs are needed; the edge holding the     */		\
+/*  minimum receives the second minimum.              */		\
+/* ================================================== */		\
+									\
+void minsum_check_node##W(sparce_matrix* s, simulation_parameters* p,int row_num) \
+{									\
+  workspace##W* w = &p->ws##W;						\
+  int i,e,d;								\
+  int sign,pos;								\
+  T a,min1,min2;							\
+									\
+  d = s->num_ones_in_row[row_num];					\
+  e = s->row_start[row_num];						\
+									\
+  sign = 0;								\
+  pos = 0;								\
+  min1 = min2 = HUGE_VAL;						\
+  for (i = 0; i <= d-1; i++) {						\
+    a = fabs(w->lq[e+i]);						\
+    if (a < min1) {							\
+      min2 = min1;							\
+      min1 = a;								\
+      pos = i;								\
+    }									\
+    else if (a < min2) min2 = a;					\
+    sign ^= (w->lq[e+i] < 0);						\
+  }									\
+				/* correction */			\
+  if (p->algorithm == ALG_NMS) {					\
+    min1 *= (T)p->ms_scale;						\
+    min2 *= (T)p->ms_scale;						\
+  }									\
+  else if (p->algorithm == ALG_OMS) {					\
+    min1 = (min1 > (T)p->ms_offset) ? min1 - (T)p->ms_offset : (T)0.0;	\
+    min2 = (min2 > (T)p->ms_offset) ? min2 - (T)p->ms_offset : (T)0.0;	\
+  }									\
+				/* extrinsic values */			\
+  for (i = 0; i <= d-1; i++) {						\
+    a = (i == pos) ? min2 : min1;					\
+    w->lr[e+i] = (sign ^ (w->lq[e+i] < 0)) ? -a : a;			\
+  }									\
+}									\
+									\
+/* ================================================== */		\
+/*  Variable node update in the LLR domain            */		\
+/* ================================================== */		\
+									\
+void llr_variable_node##W(sparce_matrix* s, simulation_parameters* p,int col_num) \
+{									\
+  workspace##W* w = &p->ws##W;						\
+  int i;								\
+  int* edge;								\
+  T sum;								\
+									\
+  edge = s->col_edge + s->col_start[col_num];				\
+  sum = w->ch_llr[col_num];	/* channel LLR */			\
+  for (i = 0; i <= s->num_ones_in_col[col_num]-1; i++)			\
+    sum += w->lr[edge[i]];						\
+									\
+  for (i = 0; i <= s->num_ones_in_col[col_num]-1; i++)			\
+    w->lq[edge[i]] = sum - w->lr[edge[i]];				\
+									\
+				/* temporary decision for each bit*/	\
+  bit_decision(s,p,col_num,(sum < 0));					\
+}									\
+									\
+/* ================================================== */		\
+/*  T-vectors of LANES(T) values and I-vectors of the */		\
+/*  same shape. A comparison gives all-ones (-1) or   */		\
+/*  all-zeros per lane.                               */		\
+/* ================================================== */		\
+									\
+typedef T vec##W __attribute__((vector_size(SIMD_BYTES)));		\
+typedef I mask##W __attribute__((vector_size(SIMD_BYTES)));		\
+									\
+static inline vec##W vsel##W(mask##W m, vec##W a, vec##W b)		\
+{									\
+  return (vec##W)((m & (mask##W)a) | (~m & (mask##W)b));		\
+}									\
+									\
+static inline vec##W vabs##W(vec##W x)					\
+{									\
+  vec##W zero = {0};							\
+  return (vec##W)((mask##W)x & ~(mask##W)(zero * -1));			\
+}									\
+									\
+/* ================================================== */		\
+/*  The BCJR algorithm for LANES(T) rows of degree d  */		\
+/*  at once. Lane l processes row rows[l]. The        */		\
+/*  arithmetic is that of bcjr##W, so the extrinsic   */		\
+/*  values are the same.                              */		\
+/* ================================================== */		\
+									\
+void bcjr_lanes##W(sparce_matrix* s, simulation_parameters* p,		\
+		   int* rows, int d)					\
+{									\
+  workspace##W* w = &p->ws##W;						\
+  const int L = LANES(T);						\
+  int i,l,e;								\
+  vec##W t0,t1,sum,zero = {0};						\
+  vec##W* a0 = (vec##W*)w->lane_a0;					\
+  vec##W* a1 = (vec##W*)w->lane_a1;					\
+  vec##W* f0 = (vec##W*)w->lane_f0;					\
+  vec##W* f1 = (vec##W*)w->lane_f1;					\
+  vec##W* b0 = (vec##W*)w->lane_b0;					\
+  vec##W* b1 = (vec##W*)w->lane_b1;					\
+				/* gathering likelihood * q */		\
+  for (l = 0; l < L; l++) {						\
+    e = s->row_start[rows[l]];						\
+    for (i = 0; i <= d-1; i++, e++) {					\
+      a0[i][l] = w->ch0[s->edge_col[e]] * w->q0[e];			\
+      a1[i][l] = w->ch1[s->edge_col[e]] * w->q1[e];			\
+    }									\
+  }									\
+				/* forward computation */		\
+  f0[0] = zero + 1;							\
+  f1[0] = zero;								\
+  for (i = 1; i <= d-1; i++) {						\
+    t0 = a0[i-1] * f0[i-1] + a1[i-1] * f1[i-1];				\
+    t1 = a1[i-1] * f0[i-1] + a0[i-1] * f1[i-1];				\
+    sum = t0 + t1;							\
+    f0[i] = t0/sum;							\
+    f1[i] = t1/sum;							\
+  }									\
+				/* backward computation */		\
+  b0[d] = zero + 1;							\
+  b1[d] = zero;								\
+  for (i = d-1; i >= 1; i--) {						\
+    t0 = a0[i] * b0[i+1] + a1[i] * b1[i+1];				\
+    t1 = a1[i] * b0[i+1] + a0[i] * b1[i+1];				\
+    sum = t0 + t1;							\
+    b0[i] = t0/sum;							\
+    b1[i] = t1/sum;							\
+  }									\
+				/* extrinsic values */			\
+  for (i = 0; i <= d-1; i++) {						\
+    a0[i] = f0[i] * b0[i+1] + f1[i] * b1[i+1];				\
+    a1[i] = f0[i] * b1[i+1] + f1[i] * b0[i+1];				\
+  }									\
+  for (l = 0; l < L; l++) {						\
+    e = s->row_start[rows[l]];						\
+    for (i = 0; i <= d-1; i++, e++) {					\
+      w->r0[e] = a0[i][l];						\
+      w->r1[e] = a1[i][l];						\
+    }									\
+  }									\
+}									\
+									\
+/* ================================================== */		\
+/*  Min-sum check node update for LANES(T) rows of    */		\
+/*  degree d at once (see minsum_check_node##W).      */		\
+/*  Branches are replaced by vsel##W, the parity of   */		\
+/*  the signs is kept as -1/+1 in sign.               */		\
+/* ================================================== */		\
+									\
+void minsum_lanes##W(sparce_matrix* s, simulation_parameters* p,	\
+		     int* rows, int d)					\
+{									\
+  workspace##W* w = &p->ws##W;						\
+  const int L = LANES(T);						\
+  int i,l,e;								\
+  vec##W a,x,min1,min2,pos,sign,zero = {0};				\
+  mask##W lt;								\
+  vec##W* q = (vec##W*)w->lane_a0;					\
+				/* gathering lq */			\
+  for (l = 0; l < L; l++) {						\
+    e = s->row_start[rows[l]];						\
+    for (i = 0; i <= d-1; i++, e++) q[i][l] = w->lq[e];			\
+  }									\
+  min1 = min2 = zero + (T)HUGE_VAL;					\
+  pos = zero;								\
+  sign = zero + 1;							\
+  for (i = 0; i <= d-1; i++) {						\
+    x = q[i];								\
+    a = vabs##W(x);							\
+    lt = a < min1;							\
+    min2 = vsel##W(lt, min1, vsel##W(a < min2, a, min2));		\
+    pos = vsel##W(lt, zero + (T)i, pos);				\
+    min1 = vsel##W(lt, a, min1);					\
+    sign = vsel##W(x < zero, -sign, sign);				\
+  }									\
+				/* correction */			\
+  if (p->algorithm == ALG_NMS) {					\
+    min1 *= (T)p->ms_scale;						\
+    min2 *= (T)p->ms_scale;						\
+  }									\
+  else if (p->algorithm == ALG_OMS) {					\
+    a = zero + (T)p->ms_offset;						\
+    min1 = vsel##W(min1 > a, min1 - a, zero);				\
+    min2 = vsel##W(min2 > a, min2 - a, zero);				\
+  }									\
+				/* extrinsic values */			\
+  for (i = 0; i <= d-1; i++) {						\
+    x = q[i];								\
+    a = vsel##W(pos == zero + (T)i, min2, min1);			\
+    q[i] = vsel##W((x < zero) ^ (sign < zero), -a, a);			\
+  }									\
+  for (l = 0; l < L; l++) {						\
+    e = s->row_start[rows[l]];						\
+    for (i = 0; i <= d-1; i++, e++) w->lr[e] = q[i][l];			\
+  }									\
+}									\
+									\
+/* ================================================== */		\
+/*  Updown algorithm for LANES(T) columns of degree d */		\
+/*  at once (see updown##W). The hard decision and    */		\
+/*  the error count are vector operations as well;    */		\
+/*  ref holds reference_bit() of each column.         */		\
+/* ================================================== */		\
+									\
+void updown_lanes##W(sparce_matrix* s, simulation_parameters* p,	\
+		     int* cols, int d)					\
+{									\
+  workspace##W* w = &p->ws##W;						\
+  const int L = LANES(T);						\
+  int i,l,errors;							\
+  int* edge;								\
+  vec##W t0,t1,sum,q0,q1,zero = {0};					\
+  mask##W m,dec,ref,err;						\
+  vec##W* a0 = (vec##W*)w->lane_a0;					\
+  vec##W* a1 = (vec##W*)w->lane_a1;					\
+  vec##W* d0 = (vec##W*)w->lane_f0;					\
+  vec##W* d1 = (vec##W*)w->lane_f1;					\
+  vec##W* u0 = (vec##W*)w->lane_b0;					\
+  vec##W* u1 = (vec##W*)w->lane_b1;					\
+  vec##W ch0,ch1;							\
+				/* gathering r0, r1 and the */		\
+				/* likelihood of the channel */		\
+  for (l = 0; l < L; l++) {						\
+    edge = s->col_edge + s->col_start[cols[l]];				\
+    for (i = 0; i <= d-1; i++) {					\
+      a0[i][l] = w->r0[edge[i]];					\
+      a1[i][l] = w->r1[edge[i]];					\
+    }									\
+    ch0[l] = w->ch0[cols[l]];						\
+    ch1[l] = w->ch1[cols[l]];						\
+    ref[l] = reference_bit(s,p,cols[l]);				\
+  }									\
+				/* downward computation */		\
+  d0[0] = d1[0] = zero + 1;						\
+  for (i = 1; i <= d; i++) {						\
+    t0 = a0[i-1] * d0[i-1];						\
+    t1 = a1[i-1] * d1[i-1];						\
+    sum = t0 + t1;							\
+    d0[i] = t0/sum;							\
+    d1[i] = t1/sum;							\
+  }									\
+				/* upward computation */		\
+  u0[d] = u1[d] = zero + 1;						\
+  for (i = d-1; i >= 0; i--) {						\
+    t0 = a0[i] * u0[i+1];						\
+    t1 = a1[i] * u1[i+1];						\
+    sum = t0 + t1;							\
+    u0[i] = t0/sum;							\
+    u1[i] = t1/sum;							\
+  }									\
+				/* update for q0 and q1 */		\
+  for (i = 0; i <= d-1; i++) {						\
+    t0 = d0[i] * u0[i+1];						\
+    t1 = d1[i] * u1[i+1];						\
+    sum = t0 + t1;							\
+    q0 = t0/sum;							\
+    q1 = t1/sum;							\
+    m = (q0 == zero);							\
+    q0 = vsel##W(m, zero + (T)1E-8, q0);				\
+    q1 = vsel##W(m, zero + (T)(1.0 - 1E-8), q1);			\
+    m = (q1 == zero);							\
+    q1 = vsel##W(m, zero + (T)1E-8, q1);				\
+    q0 = vsel##W(m, zero + (T)(1.0 - 1E-8), q0);			\
+    a0[i] = q0;								\
+    a1[i] = q1;								\
+  }									\
+				/* pseudo probability, decision and */	\
+				/* errors (decision differs from ref) */ \
+  t0 = ch0 * u0[0];							\
+  t1 = ch1 * u1[0];							\
+  sum = t0 + t1;							\
+  t0 = t0/sum;								\
+  t1 = t1/sum;								\
+  dec = -(t1 > t0);							\
+  err = (dec ^ ref) & (ref >= 0);					\
+  errors = 0;								\
+  for (l = 0; l < L; l++) {						\
+    edge = s->col_edge + s->col_start[cols[l]];				\
+    for (i = 0; i <= d-1; i++) {					\
+      w->q0[edge[i]] = a0[i][l];					\
+      w->q1[edge[i]] = a1[i][l];					\
+    }									\
+    w->tmp_q0[cols[l]] = t0[l];						\
+    w->tmp_q1[cols[l]] = t1[l];						\
+    if (p->tmp_decision[cols[l]] != dec[l]) flip_decision(s,p,cols[l]);	\
+    errors += err[l];							\
+  }									\
+  p->error_weight_in_word += errors;					\
+}									\
+									\
+/* ================================================== */		\
+/*  Check node update of the rows row_order[begin]    */		\
+/*  ... row_order[end-1]. With p->simd the rows of    */		\
+/*  each degree group are given to the lane kernels   */		\
+/*  LANES(T) at a time and the rest of the group is   */		\
+/*  processed one row at a time. The rows of a        */		\
+/*  flooding iteration are independent, so any order  */		\
+/*  and any split into ranges gives the same result.  */		\
+/* ================================================== */		\
+									\
+void check_node_range##W(sparce_matrix* s, simulation_parameters* p,	\
+			 int begin, int end)				\
+{									\
+  const int L = LANES(T);						\
+  int g,k,d,last;							\
+									\
+  if (!p->simd || (p->algorithm == ALG_LLR)) {				\
+    for (k = begin; k <= end-1; k++) {					\
+      if (p->algorithm == ALG_PROB) bcjr##W(s,p,s->row_order[k]);	\
+      else if (p->algorithm == ALG_LLR) llr_check_node##W(s,p,s->row_order[k]); \
+      else minsum_check_node##W(s,p,s->row_order[k]);			\
+    }									\
+    return;								\
+  }									\
+  for (g = 0; g <= s->num_row_groups-1; g++) {				\
+    k = (s->row_group[g] > begin) ? s->row_group[g] : begin;		\
+    last = (s->row_group[g+1] < end) ? s->row_group[g+1] : end;		\
+    if (k >= last) continue;						\
+    d = s->num_ones_in_row[s->row_order[k]];				\
+    if (d >= 2) {							\
+      for (; k + L <= last; k += L) {					\
+	if (p->algorithm == ALG_PROB) bcjr_lanes##W(s,p,s->row_order+k,d); \
+	else minsum_lanes##W(s,p,s->row_order+k,d);			\
+      }									\
+    }									\
+    for (; k <= last-1; k++) {						\
+      if (p->algorithm == ALG_PROB) bcjr##W(s,p,s->row_order[k]);	\
+      else minsum_check_node##W(s,p,s->row_order[k]);			\
+    }									\
+  }									\
+}									\
+									\
+/* check node update of all rows */					\
+									\
+void check_node_rows##W(sparce_matrix* s, simulation_parameters* p)	\
+{									\
+  check_node_range##W(s,p,0,s->M);					\
+}									\
+									\
+/* ================================================== */		\
+/*  Variable node update of the columns col_order     */		\
+/*  [begin] ... col_order[end-1]. With p->simd the    */		\
+/*  columns are grouped by degree in the same way as  */		\
+/*  the rows in check_node_range##W. The LLR domain   */		\
+/*  update is only an addition per edge, dominated by */		\
+/*  the scattered loads and stores, so it is left to  */		\
+/*  llr_variable_node##W.                             */		\
+/* ================================================== */		\
+									\
+void variable_node_range##W(sparce_matrix* s, simulation_parameters* p,	\
+			    int begin, int end)				\
+{									\
+  const int L = LANES(T);						\
+  int g,k,d,last;							\
+									\
+  if (!p->simd || (p->algorithm != ALG_PROB)) {				\
+    for (k = begin; k <= end-1; k++) {					\
+      if (p->algorithm == ALG_PROB) updown##W(s,p,s->col_order[k]);	\
+      else llr_variable_node##W(s,p,s->col_order[k]);			\
+    }									\
+    return;								\
+  }									\
+  for (g = 0; g <= s->num_col_groups-1; g++) {				\
+    k = (s->col_group[g] > begin) ? s->col_group[g] : begin;		\
+    last = (s->col_group[g+1] < end) ? s->col_group[g+1] : end;		\
+    if (k >= last) continue;						\
+    d = s->num_ones_in_col[s->col_order[k]];				\
+    if (d >= 1) {							\
+      for (; k + L <= last; k += L) updown_lanes##W(s,p,s->col_order+k,d); \
+    }									\
+    for (; k <= last-1; k++) updown##W(s,p,s->col_order[k]);		\
+  }									\
+}									\
+									\
+/* variable node update of all columns */				\
+									\
+void variable_node_cols##W(sparce_matrix* s, simulation_parameters* p)	\
+{									\
+  variable_node_range##W(s,p,0,s->N);					\
+}									\
+									\
+/* ================================================== */		\
+/*  One flooding iteration of thread sl->t of a pool  */		\
+/*  (see split_run)                                   */		\
+/* ================================================== */		\
+									\
+void split_iteration##W(split_slot* sl)					\
+{									\
+  split_pool* pool = sl->pool;						\
+  sparce_matrix* s = pool->s;						\
+									\
+  sl->view.error_weight_in_word = 0;					\
+  check_node_range##W(s,&sl->view,sl->row_begin,sl->row_end);		\
+  pthread_barrier_wait(&pool->barrier);					\
+  variable_node_range##W(s,&sl->view,sl->col_begin,sl->col_end);	\
+  pthread_barrier_wait(&pool->barrier);					\
+  split_syndrome(s,pool->param,sl);					\
+}									\
+									\
+									\
+/* ================================================== */		\
+/*  Channel metrics of the received word, computed    */		\
+/*  once per frame: the likelihoods exp(+-y/var) for  */		\
+/*  ALG_PROB and the channel LLR 2y/var otherwise.    */		\
+/* ================================================== */		\
+									\
+void channel_metrics##W(sparce_matrix* s, simulation_parameters* p)	\
+{									\
+  workspace##W* w = &p->ws##W;						\
+  int n;								\
+									\
+  if (p->algorithm == ALG_PROB) {					\
+    for (n = 0; n <= s->N-1; n++) {					\
+      w->ch0[n] = exp((T)(p->rword[n] / p->var));			\
+      w->ch1[n] = exp((T)(-p->rword[n] / p->var));			\
+    }									\
+  }									\
+  else {								\
+    for (n = 0; n <= s->N-1; n++)					\
+      w->ch_llr[n] = (T)(2.0 * p->rword[n] / p->var);			\
+  }									\
+}									\
+									\
+/* ================================================== */		\
+/*  sum product decoder                               */		\
+/*  return value = 0: success                         */		\
+/*  return value = 1: failure                         */		\
+/* ================================================== */		\
+									\
+int sum_product_decoder##W(sparce_matrix* s, simulation_parameters* param) \
+{									\
+  workspace##W* w = &param->ws##W;					\
+  int i,e;								\
+  int parity;								\
+				/* initialize q0 and q1 to be 1.0 */	\
+  for (e = 0; e <= s->num_edges-1; e++) {				\
+    w->q0[e] = 1.0;							\
+    w->q1[e] = 1.0;							\
+  }									\
+				/* iterative decoding */		\
+  for (i = 1; i <= param->max_iteration; i++) {				\
+    param->error_weight_in_word = 0;					\
+    param->num_iteration++;						\
+    if (param->split != NULL) split_run(param,SPLIT_ITER##W);		\
+    else {								\
+				/* row processing */			\
+      check_node_rows##W(s,param);					\
+									\
+				/* column processing */			\
+      variable_node_cols##W(s,param);					\
+    }									\
+									\
+				/* parity check for temporary decision */ \
+    parity = parity_check(s,param);					\
+									\
+    if (parity == 0) return 0;	/* successful decoding */		\
+    if (abandon_frame(param,i)) return 1; /* given up */		\
+  }									\
+  return 1;			/* decoding failure */			\
+}									\
+									\
+/* ================================================== */		\
+/*  LLR domain decoder (sum-product or min-sum)       */		\
+/*  return value = 0: success                         */		\
+/*  return value = 1: failure                         */		\
+/* ================================================== */		\
+									\
+int llr_decoder##W(sparce_matrix* s, simulation_parameters* param)	\
+{									\
+  workspace##W* w = &param->ws##W;					\
+  int i,n;								\
+				/* initialize lq to be the channel LLR */ \
+  for (n = 0; n <= s->N-1; n++) {					\
+    for (i = s->col_start[n]; i <= s->col_start[n+1]-1; i++)		\
+      w->lq[s->col_edge[i]] = w->ch_llr[n];				\
+  }									\
+				/* iterative decoding */		\
+  for (i = 1; i <= param->max_iteration; i++) {				\
+    param->error_weight_in_word = 0;					\
+    param->num_iteration++;						\
+    if (param->split != NULL) split_run(param,SPLIT_ITER##W);		\
+    else {								\
+				/* row processing */			\
+      check_node_rows##W(s,param);					\
+									\
+				/* column processing */			\
+      variable_node_cols##W(s,param);					\
+    }									\
+									\
+				/* parity check for temporary decision */ \
+    if (parity_check(s,param) == 0) return 0; /* successful decoding */	\
+    if (abandon_frame(param,i)) return 1; /* given up */		\
+  }									\
+  return 1;			/* decoding failure */			\
+}									\
+									\
+/* ================================================== */		\
+/*  Layered (row-serial) decoder                      */		\
+/*  The a posteriori LLRs are updated right after     */		\
+/*  each row, so later layers of the same iteration   */		\
+/*  already use the new check messages.               */		\
+/*  return value = 0: success                         */		\
+/*  return value = 1: failure                         */		\
+/* ================================================== */		\
+									\
+int layered_decoder##W(sparce_matrix* s, simulation_parameters* param)	\
+{									\
+  workspace##W* w = &param->ws##W;					\
+  int i,j,k,m,n,e;							\
+				/* initialize post to be the channel */	\
+				/* LLR and lr to be 0 */		\
+  for (n = 0; n <= s->N-1; n++) w->post[n] = w->ch_llr[n];		\
+  for (e = 0; e <= s->num_edges-1; e++) w->lr[e] = 0.0;			\
+				/* iterative decoding */		\
+  for (i = 1; i <= param->max_iteration; i++) {				\
+    param->error_weight_in_word = 0;					\
+    param->num_iteration++;						\
+    for (k = 0; k <= param->num_layers-1; k++) {			\
+      for (j = param->layer_start[k]; j <= param->layer_start[k+1]-1; j++) { \
+	m = param->layer_row[j];					\
+				/* extrinsic input of the row */	\
+	for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++)	\
+	  w->lq[e] = w->post[s->edge_col[e]] - w->lr[e];		\
+	if (param->algorithm == ALG_LLR) llr_check_node##W(s,param,m);	\
+	else minsum_check_node##W(s,param,m);				\
+				/* a posteriori update */		\
+	for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++)	\
+	  w->post[s->edge_col[e]] = w->lq[e] + w->lr[e];		\
+      }									\
+    }									\
+				/* temporary decision for each bit*/	\
+    for (n = 0; n <= s->N-1; n++) bit_decision(s,param,n,(w->post[n] < 0)); \
+				/* parity check for temporary decision */ \
+    if (parity_check(s,param) == 0) return 0; /* successful decoding */	\
+    if (abandon_frame(param,i)) return 1; /* given up */		\
+  }									\
+  return 1;			/* decoding failure */			\
+}									\
+									\
+/* ================================================== */		\
+/*  Partial state of a row for the shuffled schedule  */		\
+/*  box-plus: sh_s1 = sum of sh_phi = phi(|lq|)       */		\
+/*  min-sum : sh_s1, sh_s2 = the two smallest |lq|,   */		\
+/*            at edges sh_pos and sh_pos2             */		\
+/*  sh_sign is the parity of the signs of lq.         */		\
+/* ================================================== */		\
+									\
+void shuffled_row_state##W(sparce_matrix* s, simulation_parameters* p,	\
+			   int row_num)					\
+{									\
+  workspace##W* w = &p->ws##W;						\
+  int e,sign,pos,pos2;							\
+  T a,s1,s2;								\
+									\
+  sign = 0;								\
+  if (p->algorithm == ALG_LLR) {					\
+    s1 = 0.0;								\
+    for (e = s->row_start[row_num]; e <= s->row_start[row_num+1]-1; e++) { \
+      s1 += w->sh_phi[e];						\
+      sign ^= (w->lq[e] < 0);						\
+    }									\
+    w->sh_s1[row_num] = s1;						\
+  }									\
+  else {								\
+    s1 = s2 = HUGE_VAL;							\
+    pos = pos2 = -1;							\
+    for (e = s->row_start[row_num]; e <= s->row_start[row_num+1]-1; e++) { \
+      a = fabs(w->lq[e]);						\
+      if (a < s1) {							\
+	s2 = s1;							\
+	pos2 = pos;							\
+	s1 = a;								\
+	pos = e;							\
+      }									\
+      else if (a < s2) {						\
+	s2 = a;								\
+	pos2 = e;							\
+      }									\
+      sign ^= (w->lq[e] < 0);						\
+    }									\
+    w->sh_s1[row_num] = s1;						\
+    w->sh_s2[row_num] = s2;						\
+    w->sh_pos[row_num] = pos;						\
+    w->sh_pos2[row_num] = pos2;						\
+  }									\
+  w->sh_sign[row_num] = sign;						\
+}									\
+									\
+/* ================================================== */		\
+/*  Check to variable message of edge e in row_num    */		\
+/*  from the partial state of the row                 */		\
+/* ================================================== */		\
+									\
+T shuffled_extrinsic##W(sparce_matrix* s, simulation_parameters* p,	\
+			int row_num, int e)				\
+{									\
+  workspace##W* w = &p->ws##W;						\
+  T a;									\
+									\
+  if (p->algorithm == ALG_LLR) {					\
+    a = w->sh_s1[row_num] - w->sh_phi[e];				\
+    if (a < (T)PHI_MIN) a = (T)PHI_MIN; /* rounding of the sum */	\
+    a = phi##W(a);							\
+  }									\
+  else {								\
+    a = (e == w->sh_pos[row_num]) ? w->sh_s2[row_num] : w->sh_s1[row_num]; \
+    if (p->algorithm == ALG_NMS) a *= (T)p->ms_scale;			\
+    else if (p->algorithm == ALG_OMS)					\
+      a = (a > (T)p->ms_offset) ? a - (T)p->ms_offset : (T)0.0;		\
+  }									\
+  return (w->sh_sign[row_num] ^ (w->lq[e] < 0)) ? -a : a;		\
+}									\
+									\
+/* ================================================== */		\
+/*  lq[e] of row_num becomes x; the partial state of  */		\
+/*  the row is updated in O(1). Only when a min-sum   */		\
+/*  row loses one of its two smallest values the row  */		\
+/*  is scanned again.                                 */		\
+/* ================================================== */		\
+									\
+void shuffled_update##W(sparce_matrix* s, simulation_parameters* p,	\
+			int row_num, int e, T x)			\
+{									\
+  workspace##W* w = &p->ws##W;						\
+  T a;									\
+									\
+  w->sh_sign[row_num] ^= (w->lq[e] < 0) ^ (x < 0);			\
+  w->lq[e] = x;								\
+  if (p->algorithm == ALG_LLR) {					\
+    a = phi##W(fabs(x));						\
+    if (a > (T)PHI_MAX) a = (T)PHI_MAX;					\
+    w->sh_s1[row_num] += a - w->sh_phi[e];				\
+    w->sh_phi[e] = a;							\
+    return;								\
+  }									\
+  a = fabs(x);								\
+  if (e == w->sh_pos[row_num]) {					\
+    if (a <= w->sh_s2[row_num]) w->sh_s1[row_num] = a;			\
+    else shuffled_row_state##W(s,p,row_num);				\
+  }									\
+  else if (a < w->sh_s1[row_num]) {					\
+    w->sh_s2[row_num] = w->sh_s1[row_num];				\
+    w->sh_pos2[row_num] = w->sh_pos[row_num];				\
+    w->sh_s1[row_num] = a;						\
+    w->sh_pos[row_num] = e;						\
+  }									\
+  else if (e == w->sh_pos2[row_num]) {					\
+    if (a <= w->sh_s2[row_num]) w->sh_s2[row_num] = a;			\
+    else shuffled_row_state##W(s,p,row_num);				\
+  }									\
+  else if (a < w->sh_s2[row_num]) {					\
+    w->sh_s2[row_num] = a;						\
+    w->sh_pos2[row_num] = e;						\
+  }									\
+}									\
+									\
+/* ================================================== */		\
+/*  Shuffled (column-layered) decoder                 */		\
+/*  Columns are processed p->col_group at a time. The */		\
+/*  check messages of a group are computed from the   */		\
+/*  partial states of the rows, which already contain */		\
+/*  the messages of the preceding groups of the same  */		\
+/*  iteration. The partial states are rebuilt at the  */		\
+/*  start of every iteration.                         */		\
+/*  return value = 0: success                         */		\
+/*  return value = 1: failure                         */		\
+/* ================================================== */		\
+									\
+int shuffled_decoder##W(sparce_matrix* s, simulation_parameters* param)	\
+{									\
+  workspace##W* w = &param->ws##W;					\
+  int i,k,m,n,e,end;							\
+  T sum;								\
+				/* initialize lq to be the channel LLR */ \
+  for (n = 0; n <= s->N-1; n++) {					\
+    sum = phi##W(fabs(w->ch_llr[n]));					\
+    if (sum > (T)PHI_MAX) sum = (T)PHI_MAX;				\
+    for (i = s->col_start[n]; i <= s->col_start[n+1]-1; i++) {		\
+      w->lq[s->col_edge[i]] = w->ch_llr[n];				\
+      if (param->algorithm == ALG_LLR) w->sh_phi[s->col_edge[i]] = sum;	\
+    }									\
+  }									\
+				/* iterative decoding */		\
+  for (i = 1; i <= param->max_iteration; i++) {				\
+    param->error_weight_in_word = 0;					\
+    param->num_iteration++;						\
+    for (m = 0; m <= s->M-1; m++) shuffled_row_state##W(s,param,m);	\
+    for (k = 0; k <= s->N-1; k += param->col_group) {			\
+      end = (k + param->col_group < s->N) ? k + param->col_group : s->N; \
+				/* check messages to the group */	\
+      for (n = k; n <= end-1; n++) {					\
+	for (e = s->col_start[n]; e <= s->col_start[n+1]-1; e++)	\
+	  w->lr[s->col_edge[e]]						\
+	    = shuffled_extrinsic##W(s,param,s->col_row[e],s->col_edge[e]); \
+      }									\
+				/* variable nodes of the group */	\
+      for (n = k; n <= end-1; n++) {					\
+	sum = w->ch_llr[n];						\
+	for (e = s->col_start[n]; e <= s->col_start[n+1]-1; e++)	\
+	  sum += w->lr[s->col_edge[e]];					\
+	for (e = s->col_start[n]; e <= s->col_start[n+1]-1; e++)	\
+	  shuffled_update##W(s,param,s->col_row[e],s->col_edge[e],	\
+			     sum - w->lr[s->col_edge[e]]);		\
+	bit_decision(s,param,n,(sum < 0));				\
+      }									\
+    }									\
+				/* parity check for temporary decision */ \
+    if (parity_check(s,param) == 0) return 0; /* successful decoding */	\
+    if (abandon_frame(param,i)) return 1; /* given up */		\
+  }									\
+  return 1;			/* decoding failure */			\
+}									\
+									\
+/* ================================================== */		\
+/*  Indexed max-heap of the rows keyed by rb_res for  */		\
+/*  the residual decoder. rb_heap[0] is the row with  */		\
+/*  the largest residual, rb_pos is the position of a */		\
+/*  row in rb_heap.                                   */		\
+/* ================================================== */		\
+									\
+void heap_up##W(workspace##W* w, int i)					\
+{									\
+  int m;								\
+									\
+  m = w->rb_heap[i];							\
+  while ((i > 0) && (w->rb_res[w->rb_heap[(i-1)/2]] < w->rb_res[m])) {	\
+    w->rb_heap[i] = w->rb_heap[(i-1)/2];				\
+    w->rb_pos[w->rb_heap[i]] = i;					\
+    i = (i-1)/2;							\
+  }									\
+  w->rb_heap[i] = m;							\
+  w->rb_pos[m] = i;							\
+}									\
+									\
+void heap_down##W(workspace##W* w, int num, int i)			\
+{									\
+  int c,m;								\
+									\
+  m = w->rb_heap[i];							\
+  while ((c = 2*i+1) <= num-1) {					\
+    if ((c+1 <= num-1)							\
+	&& (w->rb_res[w->rb_heap[c+1]] > w->rb_res[w->rb_heap[c]])) c++; \
+    if (w->rb_res[w->rb_heap[c]] <= w->rb_res[m]) break;		\
+    w->rb_heap[i] = w->rb_heap[c];					\
+    w->rb_pos[w->rb_heap[i]] = i;					\
+    i = c;								\
+  }									\
+  w->rb_heap[i] = m;							\
+  w->rb_pos[m] = i;							\
+}									\
+									\
+/* ================================================== */		\
+/*  Candidate check messages rb_new of a row from the */		\
+/*  current a posteriori LLRs, and the residual       */		\
+/*  max |rb_new - lr| of the row                      */		\
+/* ================================================== */		\
+									\
+void residual_row##W(sparce_matrix* s, simulation_parameters* p, int row_num) \
+{									\
+  workspace##W* w = &p->ws##W;						\
+  int e;								\
+  T* lr;								\
+  T r,d;								\
+									\
+  for (e = s->row_start[row_num]; e <= s->row_start[row_num+1]-1; e++)	\
+    w->lq[e] = w->post[s->edge_col[e]] - w->lr[e];			\
+				/* the check node kernels write */	\
+				/* the candidates into rb_new */	\
+  lr = w->lr;								\
+  w->lr = w->rb_new;							\
+  if (p->algorithm == ALG_LLR) llr_check_node##W(s,p,row_num);		\
+  else minsum_check_node##W(s,p,row_num);				\
+  w->lr = lr;								\
+									\
+  r = 0.0;								\
+  for (e = s->row_start[row_num]; e <= s->row_start[row_num+1]-1; e++) { \
+    d = fabs(w->rb_new[e] - w->lr[e]);					\
+    if (d > r) r = d;							\
+  }									\
+  w->rb_res[row_num] = r;						\
+}									\
+									\
+/* ================================================== */		\
+/*  Residual belief propagation decoder               */		\
+/*  The row with the largest residual is updated      */		\
+/*  first; afterwards only the rows sharing a column  */		\
+/*  with it get new candidates. M row updates count   */		\
+/*  as one iteration, followed by the hard decision   */		\
+/*  and the parity check.                             */		\
+/*  return value = 0: success                         */		\
+/*  return value = 1: failure                         */		\
+/* ================================================== */		\
+									\
+int residual_decoder##W(sparce_matrix* s, simulation_parameters* param)	\
+{									\
+  workspace##W* w = &param->ws##W;					\
+  int i,j,k,m,n,e,f,g,stamp;						\
+				/* initialize post to be the channel */	\
+				/* LLR and lr to be 0 */		\
+  for (n = 0; n <= s->N-1; n++) w->post[n] = w->ch_llr[n];		\
+  for (e = 0; e <= s->num_edges-1; e++) w->lr[e] = 0.0;			\
+  for (m = 0; m <= s->M-1; m++) {					\
+    residual_row##W(s,param,m);						\
+    w->rb_heap[m] = m;							\
+    w->rb_mark[m] = -1;							\
+  }									\
+  for (m = s->M/2-1; m >= 0; m--) heap_down##W(w,s->M,m);		\
+  stamp = 0;								\
+				/* iterative decoding */		\
+  for (i = 1; i <= param->max_iteration; i++) {				\
+    param->error_weight_in_word = 0;					\
+    param->num_iteration++;						\
+    for (j = 0; j <= s->M-1; j++) {					\
+      m = w->rb_heap[0];						\
+      if (w->rb_res[m] == 0) break; /* no message would change */	\
+				/* apply the candidates of row m */	\
+      for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++) {	\
+	w->post[s->edge_col[e]] += w->rb_new[e] - w->lr[e];		\
+	w->lr[e] = w->rb_new[e];					\
+      }									\
+      w->rb_res[m] = 0.0;						\
+      heap_down##W(w,s->M,0);						\
+				/* new candidates of the rows */	\
+				/* sharing a column with row m */	\
+      stamp++;								\
+      w->rb_mark[m] = stamp;						\
+      for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++) {	\
+	n = s->edge_col[e];						\
+	for (f = s->col_start[n]; f <= s->col_start[n+1]-1; f++) {	\
+	  g = s->col_row[f];						\
+	  if (w->rb_mark[g] == stamp) continue;				\
+	  w->rb_mark[g] = stamp;					\
+	  residual_row##W(s,param,g);					\
+	  k = w->rb_pos[g];						\
+	  heap_up##W(w,k);						\
+	  heap_down##W(w,s->M,w->rb_pos[g]);				\
+	}								\
+      }									\
+    }									\
+				/* temporary decision for each bit*/	\
+    for (n = 0; n <= s->N-1; n++) bit_decision(s,param,n,(w->post[n] < 0)); \
+				/* parity check for temporary decision */ \
+    if (parity_check(s,param) == 0) return 0; /* successful decoding */	\
+    if (abandon_frame(param,i)) return 1; /* given up */		\
+  }									\
+  return 1;			/* decoding failure */			\
+}									\
+									\
+/* allocation of the work areas of the node updates */			\
+									\
+void alloc_scratch##W(sparce_matrix* s, workspace##W* w)		\
+{									\
+  int row,col,lane;							\
+									\
+  row = s->biggest_num_ones_row;					\
+  col = s->biggest_num_ones_col;					\
+				/* one vec##W per position in a row */	\
+				/* or column */				\
+  lane = SIMD_BYTES*(((row > col) ? row : col)+1);			\
+  if (((w->bcjr_for0 = (T*)malloc(sizeof(T)*(row+1))) == NULL)		\
+      || ((w->bcjr_for1 = (T*)malloc(sizeof(T)*(row+1))) == NULL)	\
+      || ((w->bcjr_back0 = (T*)malloc(sizeof(T)*(row+1))) == NULL)	\
+      || ((w->bcjr_back1 = (T*)malloc(sizeof(T)*(row+1))) == NULL)	\
+      || ((w->bcjr_tmp0 = (T*)malloc(sizeof(T)*row)) == NULL)		\
+      || ((w->bcjr_tmp1 = (T*)malloc(sizeof(T)*row)) == NULL)		\
+      || ((w->bcjr_tmp_q0 = (T*)malloc(sizeof(T)*row)) == NULL)		\
+      || ((w->bcjr_tmp_q1 = (T*)malloc(sizeof(T)*row)) == NULL)		\
+      || ((w->ud_upward0 = (T*)malloc(sizeof(T)*(col+1))) == NULL)	\
+      || ((w->ud_upward1 = (T*)malloc(sizeof(T)*(col+1))) == NULL)	\
+      || ((w->ud_downward0 = (T*)malloc(sizeof(T)*(col+1))) == NULL)	\
+      || ((w->ud_downward1 = (T*)malloc(sizeof(T)*(col+1))) == NULL)	\
+      || ((w->ud_tmp0 = (T*)malloc(sizeof(T)*(col+1))) == NULL)		\
+      || ((w->ud_tmp1 = (T*)malloc(sizeof(T)*(col+1))) == NULL)		\
+      || ((w->llr_phi = (T*)malloc(sizeof(T)*row)) == NULL)		\
+      || ((w->llr_for = (T*)malloc(sizeof(T)*(row+1))) == NULL)		\
+      || ((w->lane_a0 = (T*)aligned_alloc(SIMD_BYTES,lane)) == NULL)	\
+      || ((w->lane_a1 = (T*)aligned_alloc(SIMD_BYTES,lane)) == NULL)	\
+      || ((w->lane_f0 = (T*)aligned_alloc(SIMD_BYTES,lane)) == NULL)	\
+      || ((w->lane_f1 = (T*)aligned_alloc(SIMD_BYTES,lane)) == NULL)	\
+      || ((w->lane_b0 = (T*)aligned_alloc(SIMD_BYTES,lane)) == NULL)	\
+      || ((w->lane_b1 = (T*)aligned_alloc(SIMD_BYTES,lane)) == NULL)) {	\
+    fprintf(stderr,"Can't allocate memory\n");				\
+    exit(-1);								\
+  }									\
+}									\
+									\
+/* allocation of the messages and work areas */				\
+									\
+void alloc_workspace##W(sparce_matrix* s, simulation_parameters* p)	\
+{									\
+  workspace##W* w = &p->ws##W;						\
+									\
+  w->r0 = w->r1 = w->q0 = w->q1 = NULL;					\
+  w->lr = w->lq = NULL;							\
+  w->ch0 = w->ch1 = w->ch_llr = w->post = NULL;				\
+  w->sh_phi = w->sh_s1 = w->sh_s2 = NULL;				\
+  w->sh_pos = w->sh_pos2 = w->sh_sign = NULL;				\
+  w->rb_new = w->rb_res = NULL;						\
+  w->rb_heap = w->rb_pos = w->rb_mark = NULL;				\
+				/* messages: two values per direction for */ \
+				/* ALG_PROB, one LLR per direction otherwise */ \
+  if (p->algorithm == ALG_PROB) {					\
+    if (((w->r0 = (T*)malloc(sizeof(T)*s->num_edges)) == NULL)		\
+	|| ((w->r1 = (T*)malloc(sizeof(T)*s->num_edges)) == NULL)	\
+	|| ((w->q0 = (T*)malloc(sizeof(T)*s->num_edges)) == NULL)	\
+	|| ((w->q1 = (T*)malloc(sizeof(T)*s->num_edges)) == NULL)	\
+	|| ((w->ch0 = (T*)malloc(sizeof(T)*s->N)) == NULL)		\
+	|| ((w->ch1 = (T*)malloc(sizeof(T)*s->N)) == NULL)) {		\
+      fprintf(stderr,"Can't allocate memory\n");			\
+      exit(-1);								\
+    }									\
+  }									\
+  else {								\
+    if (((w->lr = (T*)malloc(sizeof(T)*s->num_edges)) == NULL)		\
+	|| ((w->lq = (T*)malloc(sizeof(T)*s->num_edges)) == NULL)	\
+	|| ((w->ch_llr = (T*)malloc(sizeof(T)*s->N)) == NULL)		\
+	|| ((w->post = (T*)malloc(sizeof(T)*s->N)) == NULL)) {		\
+      fprintf(stderr,"Can't allocate memory\n");			\
+      exit(-1);								\
+    }									\
+    if ((p->schedule == SCHED_SHUFFLED)					\
+	&& (((w->sh_phi = (T*)malloc(sizeof(T)*s->num_edges)) == NULL)	\
+	    || ((w->sh_s1 = (T*)malloc(sizeof(T)*s->M)) == NULL)	\
+	    || ((w->sh_s2 = (T*)malloc(sizeof(T)*s->M)) == NULL)	\
+	    || ((w->sh_pos = (int*)malloc(sizeof(int)*s->M)) == NULL)	\
+	    || ((w->sh_pos2 = (int*)malloc(sizeof(int)*s->M)) == NULL)	\
+	    || ((w->sh_sign = (int*)malloc(sizeof(int)*s->M)) == NULL))) { \
+      fprintf(stderr,"Can't allocate memory\n");			\
+      exit(-1);								\
+    }									\
+    if ((p->schedule == SCHED_RESIDUAL)					\
+	&& (((w->rb_new = (T*)malloc(sizeof(T)*s->num_edges)) == NULL)	\
+	    || ((w->rb_res = (T*)malloc(sizeof(T)*s->M)) == NULL)	\
+	    || ((w->rb_heap = (int*)malloc(sizeof(int)*s->M)) == NULL)	\
+	    || ((w->rb_pos = (int*)malloc(sizeof(int)*s->M)) == NULL)	\
+	    || ((w->rb_mark = (int*)malloc(sizeof(int)*s->M)) == NULL))) { \
+      fprintf(stderr,"Can't allocate memory\n");			\
+      exit(-1);								\
+    }									\
+  }									\
+  alloc_scratch##W(s,w);						\
+  if (((w->tmp_q0 = (T*)malloc(sizeof(T)*s->N)) == NULL)		\
+      || ((w->tmp_q1 = (T*)malloc(sizeof(T)*s->N)) == NULL)) {		\
+    fprintf(stderr,"Can't allocate memory\n");				\
+    exit(-1);								\
+  }									\
+}									\
+									\
+/* ================================================== */		\
+/*  Multi-frame decoding (-lanes)                     */		\
+/*  LANES(T) frames are decoded side by side by the   */		\
+/*  flooding min-sum. The messages of an edge, and    */		\
+/*  the channel LLR and the decision of a column, of  */		\
+/*  all lanes are one vec##W, so that every node      */		\
+/*  update is a vector operation on contiguous data   */		\
+/*  and the row and column degrees need not be equal. */		\
+/*  The arithmetic is that of minsum_check_node##W    */		\
+/*  and llr_variable_node##W, so a frame has the same */		\
+/*  decisions and iterations in any lane as alone.    */		\
+/*  Idle lanes hold zeros or an old frame; they are   */		\
+/*  updated but not looked at. The lanes are loaded   */		\
+/*  and unloaded one at a time by lane_batch.         */		\
+/* ================================================== */		\
+									\
+void alloc_frames##W(sparce_matrix* s, simulation_parameters* p)	\
+{									\
+  workspace##W* w = &p->ws##W;						\
+  size_t e = (size_t)SIMD_BYTES * s->num_edges;				\
+  size_t n = (size_t)SIMD_BYTES * s->N;					\
+									\
+  if (((w->fr_lq = (T*)aligned_alloc(SIMD_BYTES,e)) == NULL)		\
+      || ((w->fr_lr = (T*)aligned_alloc(SIMD_BYTES,e)) == NULL)		\
+      || ((w->fr_ch = (T*)aligned_alloc(SIMD_BYTES,n)) == NULL)		\
+      || ((w->fr_dec = (T*)aligned_alloc(SIMD_BYTES,n)) == NULL)) {	\
+    fprintf(stderr,"Can't allocate memory\n");				\
+    exit(-1);								\
+  }									\
+  memset(w->fr_lq,0,e);							\
+  memset(w->fr_lr,0,e);							\
+  memset(w->fr_ch,0,n);							\
+  memset(w->fr_dec,0,n);						\
+}									\
+									\
+/* the frame of ch_llr goes into lane l (see llr_decoder##W) */		\
+									\
+void load_lane##W(sparce_matrix* s, simulation_parameters* p, int l)	\
+{									\
+  workspace##W* w = &p->ws##W;						\
+  vec##W* lq = (vec##W*)w->fr_lq;					\
+  vec##W* ch = (vec##W*)w->fr_ch;					\
+  mask##W* dec = (mask##W*)w->fr_dec;					\
+  int i,n;								\
+									\
+  for (n = 0; n <= s->N-1; n++) {					\
+    ch[n][l] = w->ch_llr[n];						\
+    dec[n][l] = 0;							\
+    for (i = s->col_start[n]; i <= s->col_start[n+1]-1; i++)		\
+      lq[s->col_edge[i]][l] = w->ch_llr[n];				\
+  }									\
+}									\
+									\
+/* the decisions of lane l go to tmp_decision */			\
+									\
+void unload_lane##W(sparce_matrix* s, simulation_parameters* p, int l)	\
+{									\
+  mask##W* dec = (mask##W*)p->ws##W.fr_dec;				\
+  int n;								\
+									\
+  for (n = 0; n <= s->N-1; n++) p->tmp_decision[n] = (dec[n][l] != 0);	\
+}									\
+									\
+/* ================================================== */		\
+/*  One flooding iteration of all lanes; the number   */		\
+/*  of unsatisfied checks of lane l is put into       */		\
+/*  unsatisfied[l].                                   */		\
+/* ================================================== */		\
+									\
+void lane_iteration##W(sparce_matrix* s, simulation_parameters* p,	\
+		       int* unsatisfied)				\
+{									\
+  workspace##W* w = &p->ws##W;						\
+  const int L = LANES(T);						\
+  int i,l,m,n,e,d;							\
+  int* edge;								\
+  vec##W a,x,min1,min2,pos,sign,sum,zero = {0};				\
+  vec##W scale = zero + (T)p->ms_scale;					\
+  vec##W offset = zero + (T)p->ms_offset;				\
+  mask##W lt,syn,uns,none = {0};					\
+  vec##W* lq = (vec##W*)w->fr_lq;					\
+  vec##W* lr = (vec##W*)w->fr_lr;					\
+  vec##W* ch = (vec##W*)w->fr_ch;					\
+  mask##W* dec = (mask##W*)w->fr_dec;					\
+				/* row processing */			\
+  for (m = 0; m <= s->M-1; m++) {					\
+    d = s->num_ones_in_row[m];						\
+    e = s->row_start[m];						\
+    min1 = min2 = zero + (T)HUGE_VAL;					\
+    pos = zero;								\
+    sign = zero + 1;							\
+    for (i = 0; i <= d-1; i++) {					\
+      x = lq[e+i];							\
+      a = vabs##W(x);							\
+      lt = a < min1;							\
+      min2 = vsel##W(lt, min1, vsel##W(a < min2, a, min2));		\
+      pos = vsel##W(lt, zero + (T)i, pos);				\
+      min1 = vsel##W(lt, a, min1);					\
+      sign = vsel##W(x < zero, -sign, sign);				\
+    }									\
+    if (p->algorithm == ALG_NMS) {					\
+      min1 *= scale;							\
+      min2 *= scale;							\
+    }									\
+    else if (p->algorithm == ALG_OMS) {					\
+      min1 = vsel##W(min1 > offset, min1 - offset, zero);		\
+      min2 = vsel##W(min2 > offset, min2 - offset, zero);		\
+    }									\
+    for (i = 0; i <= d-1; i++) {					\
+      x = lq[e+i];							\
+      a = vsel##W(pos == zero + (T)i, min2, min1);			\
+      lr[e+i] = vsel##W((x < zero) ^ (sign < zero), -a, a);		\
+    }									\
+  }									\
+				/* column processing */			\
+  for (n = 0; n <= s->N-1; n++) {					\
+    edge = s->col_edge + s->col_start[n];				\
+    d = s->num_ones_in_col[n];						\
+    sum = ch[n];							\
+    for (i = 0; i <= d-1; i++) sum += lr[edge[i]];			\
+    for (i = 0; i <= d-1; i++) lq[edge[i]] = sum - lr[edge[i]];		\
+    dec[n] = (sum < zero);						\
+  }									\
+				/* syndrome of each lane */		\
+  uns = none;								\
+  for (m = 0; m <= s->M-1; m++) {					\
+    syn = none;								\
+    for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++) 		\
+      syn ^= dec[s->edge_col[e]];					\
+    uns -= syn;								\
+  }									\
+  for (l = 0; l < L; l++) unsatisfied[l] = uns[l];			\
+}									\
+									\
+/* decoder selected by p->schedule and p->algorithm */			\
+									\
+int decoder##W(sparce_matrix* s, simulation_parameters* p)		\
+{									\
+  init_syndrome(s,p);							\
+  if (p->schedule == SCHED_LAYERED) return layered_decoder##W(s,p);	\
+  if (p->schedule == SCHED_SHUFFLED) return shuffled_decoder##W(s,p);	\
+  if (p->schedule == SCHED_RESIDUAL) return residual_decoder##W(s,p);	\
+  if (p->algorithm == ALG_PROB) return sum_product_decoder##W(s,p);	\
+  return llr_decoder##W(s,p);						\
+}
+
+FLOAT_DECODER(double,long long,64)
+FLOAT_DECODER(float,int,32)
+
+/* ================================================== */
+/*  Threads of the intra-frame pool (see split_slot)  */
+/*  A command starts and ends at a barrier of all     */
+/*  threads of the pool.                              */
+/* ================================================== */
+
+void split_command(split_slot* sl)
+{
+  if (sl->pool->command == SPLIT_ITER64) split_iteration64(sl);
+  else split_iteration32(sl);
+}
+
+void* split_thread(void* arg)
+{
+  split_slot* sl = (split_slot*)arg;
+
+  while (1) {
+    pthread_barrier_wait(&sl->pool->barrier);
+    split_command(sl);
+    pthread_barrier_wait(&sl->pool->barrier);
   }
-  if ((param->bcjr_back0
-       = (double*)malloc(sizeof(double)*(s->biggest_num_ones_row + 1))) 
-      == NULL) {
-    fprintf(stderr,"Can't allocate memory\n");
-    exit(-1);
+  return NULL;
+}
+
+/* one iteration of the frame param on all threads; the */
+/* error weights and unsatisfied checks are summed      */
+
+void split_run(simulation_parameters* param, int command)
+{
+  split_pool* pool = param->split;
+  int t;
+
+  pool->command = command;
+  pthread_barrier_wait(&pool->barrier);
+  split_command(&pool->slot[0]);
+  pthread_barrier_wait(&pool->barrier);
+  param->unsatisfied = 0;
+  for (t = 0; t <= pool->threads-1; t++) {
+    param->error_weight_in_word += pool->slot[t].view.error_weight_in_word;
+    param->unsatisfied += pool->slot[t].view.unsatisfied;
   }
-  if ((param->bcjr_back1
-       = (double*)malloc(sizeof(double)*(s->biggest_num_ones_row + 1))) 
-      == NULL) {
-    fprintf(stderr,"Can't allocate memory\n");
-    exit(-1);
+}
+
+/* ================================================== */
+/*  Ranges of nodes order[bound[t]] ... order[bound   */
+/*  [t+1]-1] of threads t = 0 ... threads-1 with      */
+/*  about the same number of edges                    */
+/* ================================================== */
+
+void split_bounds(int num, int* order, int* degree, int edges,
+		  int threads, int* bound)
+{
+  int t,k;
+  long long sum;
+
+  k = 0;
+  sum = 0;
+  for (t = 0; t <= threads-1; t++) {
+    bound[t] = k;
+    while ((k <= num-1) && (sum * threads < (long long)(t+1) * edges)) 
+      sum += degree[order[k++]];
   }
+  bound[threads] = num;
+}
 
-  if ((param->bcjr_tmp0
-       = (double*)malloc(sizeof(double)*s->biggest_num_ones_row)) 
-      == NULL) {
+/* ================================================== */
+/*  The pool of param->split_threads threads for the  */
+/*  frames of param; the caller is thread 0.          */
+/* ================================================== */
+
+void init_split(sparce_matrix* s, simulation_parameters* param)
+{
+  split_pool* pool;
+  split_slot* sl;
+  int t,n;
+  int* rows;
+  int* cols;
+
+  n = param->split_threads;
+  if (((pool = (split_pool*)malloc(sizeof(split_pool))) == NULL)
+      || ((pool->slot = (split_slot*)aligned_alloc(CACHE_LINE,
+					       sizeof(split_slot)*n)) == NULL)
+      || ((rows = (int*)malloc(sizeof(int)*(n+1))) == NULL)
+      || ((cols = (int*)malloc(sizeof(int)*(n+1))) == NULL)) {
     fprintf(stderr,"Can't allocate memory\n");
     exit(-1);
   }
+  pool->threads = n;
+  pool->s = s;
+  pool->param = param;
+  pthread_barrier_init(&pool->barrier,NULL,n);
+  split_bounds(s->M,s->row_order,s->num_ones_in_row,s->num_edges,n,rows);
+  split_bounds(s->N,s->col_order,s->num_ones_in_col,s->num_edges,n,cols);
+
+  for (t = 0; t <= n-1; t++) {
+    sl = &pool->slot[t];
+    sl->pool = pool;
+    sl->t = t;
+    sl->row_begin = rows[t];
+    sl->row_end = rows[t+1];
+    sl->col_begin = cols[t];
+    sl->col_end = cols[t+1];
+				/* a view of the frame with its own */
+				/* work areas and no syndrome */
+    sl->view = *param;
+    sl->view.syndrome = NULL;
+    if (param->precision != PREC_FLOAT) alloc_scratch64(s,&sl->view.ws64);
+    if (param->precision != PREC_DOUBLE) alloc_scratch32(s,&sl->view.ws32);
+  }
+  free(rows);
+  free(cols);
+  param->split = pool;
+
+  for (t = 1; t <= n-1; t++) {
+    if (pthread_create(&pool->slot[t].thread,NULL,
+		       split_thread,&pool->slot[t]) != 0) {
+      fprintf(stderr,"Can't create a thread\n");
+      exit(-1);
+    }
+  }
+}
 
-  if ((param->bcjr_tmp1
-       = (double*)malloc(sizeof(double)*s->biggest_num_ones_row)) 
-      == NULL) {
-    fprintf(stderr,"Can't allocate memory\n");
-    exit(-1);
+/* ================================================== */
+/*  Quantization of an LLR with rounding and          */
+/*  saturation to [-max,max]                          */
+/* ================================================== */
+
+int quantize(double llr, double step, int max)
+{
+  double x;
+
+  x = floor(llr / step + 0.5);
+  if (x > max) return max;
+  if (x < -max) return -max;
+  return (int)x;
+}
+
+/* ================================================== */
+/*  Quantized min-sum decoder                         */
+/*  QUANTIZED_DECODER(T,W) defines q_check_node##W,   */
+/*  q_variable_node##W and q_decoder##W for messages  */
+/*  of type T stored in qr##W, qq##W and qch##W.      */
+/*  The posterior sum is kept in an int and the       */
+/*  messages saturate at +-qmax.  The normalized      */
+/*  min-sum multiplies by qscale/16 (rounded to the   */
+/*  nearest step).                                    */
+/* ================================================== */
+
+#define QUANTIZED_DECODER(T,W)						\
+									\
+void q_check_node##W(sparce_matrix* s, simulation_parameters* p,int row_num) \
+{									\
+  int i,d;								\
+  int sign,pos;								\
+  int a,min1,min2;							\
+  T* q;									\
+  T* r;									\
+									\
+  d = s->num_ones_in_row[row_num];					\
+  q = p->qq##W + s->row_start[row_num];					\
+  r = p->qr##W + s->row_start[row_num];					\
+									\
+  sign = 0;								\
+  pos = 0;								\
+  min1 = min2 = p->qmax;						\
+  for (i = 0; i <= d-1; i++) {						\
+    a = (q[i] < 0) ? -q[i] : q[i];					\
+    if (a < min1) {							\
+      min2 = min1;							\
+      min1 = a;								\
+      pos = i;								\
+    }									\
+    else if (a < min2) min2 = a;					\
+    sign ^= (q[i] < 0);							\
+  }									\
+  if (p->algorithm == ALG_NMS) {					\
+    min1 = (min1 * p->qscale + 8) >> 4;					\
+    min2 = (min2 * p->qscale + 8) >> 4;					\
+  }									\
+  else if (p->algorithm == ALG_OMS) {					\
+    min1 = (min1 > p->qoffset) ? min1 - p->qoffset : 0;			\
+    min2 = (min2 > p->qoffset) ? min2 - p->qoffset : 0;			\
+  }									\
+  for (i = 0; i <= d-1; i++) {						\
+    a = (i == pos) ? min2 : min1;					\
+    r[i] = (T)((sign ^ (q[i] < 0)) ? -a : a);				\
+  }									\
+}									\
+									\
+void q_variable_node##W(sparce_matrix* s, simulation_parameters* p,int col_num) \
+{									\
+  int i,t,sum;								\
+  int* edge;								\
+									\
+  edge = s->col_edge + s->col_start[col_num];				\
+  sum = p->qch##W[col_num];						\
+  for (i = 0; i <= s->num_ones_in_col[col_num]-1; i++)			\
+    sum += p->qr##W[edge[i]];						\
+									\
+  for (i = 0; i <= s->num_ones_in_col[col_num]-1; i++) {		\
+    t = sum - p->qr##W[edge[i]];					\
+    if (t > p->qmax) t = p->qmax;					\
+    if (t < -p->qmax) t = -p->qmax;					\
+    p->qq##W[edge[i]] = (T)t;						\
+  }									\
+  bit_decision(s,p,col_num,(sum < 0));					\
+}									\
+									\
+int q_decoder##W(sparce_matrix* s, simulation_parameters* param)	\
+{									\
+  int i,n,m,t;								\
+									\
+  init_syndrome(s,param);						\
+				/* quantized channel LLR */		\
+  for (n = 0; n <= s->N-1; n++) {					\
+    param->qch##W[n] = (T)quantize(2.0 * param->rword[n] / param->var,	\
+				   param->qstep, param->qch_max);	\
+    t = param->qch##W[n];						\
+    if (t > param->qmax) t = param->qmax;				\
+    if (t < -param->qmax) t = -param->qmax;				\
+    for (i = s->col_start[n]; i <= s->col_start[n+1]-1; i++)		\
+      param->qq##W[s->col_edge[i]] = (T)t;				\
+  }									\
+				/* iterative decoding */		\
+  for (i = 1; i <= param->max_iteration; i++) {				\
+    param->error_weight_in_word = 0;					\
+    param->num_iteration++;						\
+    for (m = 0; m <= s->M-1; m++) q_check_node##W(s,param,m);		\
+    for (n = 0; n <= s->N-1; n++) q_variable_node##W(s,param,n);	\
+    if (parity_check(s,param) == 0) return 0;				\
+    if (abandon_frame(param,i)) return 1;				\
+  }									\
+  return 1;								\
+}
+
+QUANTIZED_DECODER(signed char,8)
+QUANTIZED_DECODER(short,16)
+
+/* ================================================== */
+/*  Bitsliced hard-decision decoders (-alg gala, galb */
+/*  and bf)                                           */
+/*  Bit l of a uint64_t belongs to frame l, so that   */
+/*  HARD_LANES frames are decoded at once by word     */
+/*  operations: a parity is an XOR, and the number of */
+/*  checks of a column that disagree with its channel */
+/*  bit (or are unsatisfied) is kept in bit planes    */
+/*  c[0], c[1], ... of a counter and compared with a  */
+/*  threshold (hd_add, hd_at_least). The channel is   */
+/*  the hard decision (rword < 0) of the received     */
+/*  word.                                             */
+/*  gala: Gallager-A; a column sends the flipped      */
+/*        channel bit to a check iff all its other    */
+/*        checks disagree with the channel bit.       */
+/*  galb: Gallager-B; iff more than half of the other */
+/*        checks disagree.                            */
+/*        The decision of gala and galb is the        */
+/*        majority of the channel bit and all the     */
+/*        checks (a tie keeps the channel bit).       */
+/*  bf:   parallel bit flipping; all the bits with    */
+/*        more unsatisfied than satisfied checks flip */
+/*        at once.                                    */
+/*  hard_decoder decodes one frame in lane 0, and     */
+/*  -lanes fills all the lanes (see lane_batch).      */
+/* ================================================== */
+
+/* adding the bits x to the counter c of planes planes */
+
+static inline void hd_add(uint64_t* c, int planes, uint64_t x)
+{
+  uint64_t carry;
+  int j;
+
+  for (j = 0; (j <= planes-1) && (x != 0); j++) {
+    carry = c[j] & x;
+    c[j] ^= x;
+    x = carry;
   }
+}
 
-  if ((param->bcjr_tmp_q0
-       = (double*)malloc(sizeof(double)*s->biggest_num_ones_row)) 
-      == NULL) {
-    fprintf(stderr,"Can't allocate memory\n");
-    exit(-1);
+/* the lanes whose counter is t or more */
+
+static inline uint64_t hd_at_least(uint64_t* c, int planes, int t)
+{
+  uint64_t gt,eq;
+  int j;
+
+  if (t <= 0) return ~(uint64_t)0;
+  if (t >> planes) return 0;
+  gt = 0;
+  eq = ~(uint64_t)0;
+  for (j = planes-1; j >= 0; j--) {
+    if ((t >> j) & 1) eq &= c[j];
+    else {
+      gt |= eq & c[j];
+      eq &= ~c[j];
+    }
   }
+  return gt | eq;
+}
 
-  if ((param->bcjr_tmp_q1
-       = (double*)malloc(sizeof(double)*s->biggest_num_ones_row)) 
-      == NULL) {
-    fprintf(stderr,"Can't allocate memory\n");
-    exit(-1);
+/* the channel bits of the frame of rword go into lane l */
+
+void load_hard(sparce_matrix* s, simulation_parameters* p, int l)
+{
+  uint64_t bit = (uint64_t)1 << l;
+  uint64_t y;
+  int i,n;
+
+  for (n = 0; n <= s->N-1; n++) {
+    y = (p->rword[n] < 0) ? bit : 0;
+    p->hd_ch[n] = (p->hd_ch[n] & ~bit) | y;
+    p->hd_dec[n] = (p->hd_dec[n] & ~bit) | y;
+    for (i = s->col_start[n]; i <= s->col_start[n+1]-1; i++)
+      p->hd_q[s->col_edge[i]] = (p->hd_q[s->col_edge[i]] & ~bit) | y;
   }
+}
 
-  if ((param->ud_upward0
-       = (double*)malloc(sizeof(double)*(s->biggest_num_ones_col+1))) 
-      == NULL) {
+/* the decisions of lane l go to tmp_decision */
+
+void unload_hard(sparce_matrix* s, simulation_parameters* p, int l)
+{
+  int n;
+
+  for (n = 0; n <= s->N-1; n++) p->tmp_decision[n] = (p->hd_dec[n] >> l) & 1;
+}
+
+/* syndrome of the decisions into hd_syn; */
+/* return value = the lanes with an unsatisfied check */
+
+uint64_t hard_syndrome(sparce_matrix* s, simulation_parameters* p)
+{
+  uint64_t syn,any;
+  int m,e;
+
+  any = 0;
+  for (m = 0; m <= s->M-1; m++) {
+    syn = 0;
+    for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++) 
+      syn ^= p->hd_dec[s->edge_col[e]];
+    p->hd_syn[m] = syn;
+    any |= syn;
+  }
+  return any;
+}
+
+/* ================================================== */
+/*  One iteration of all lanes                        */
+/*  return value = the lanes whose decision is not a  */
+/*  codeword                                          */
+/* ================================================== */
+
+uint64_t hard_iteration(sparce_matrix* s, simulation_parameters* p)
+{
+  uint64_t c[32];
+  uint64_t par,ch,own,flip,flip1;
+  int i,j,m,n,e,d,b;
+  int* edge;
+
+  if (p->algorithm == ALG_BF) {
+    hard_syndrome(s,p);
+    for (n = 0; n <= s->N-1; n++) {
+      edge = s->col_row + s->col_start[n];
+      d = s->num_ones_in_col[n];
+      for (j = 0; j <= p->hd_planes-1; j++) c[j] = 0;
+      for (i = 0; i <= d-1; i++) hd_add(c,p->hd_planes,p->hd_syn[edge[i]]);
+      p->hd_dec[n] ^= hd_at_least(c,p->hd_planes,d/2+1);
+    }
+    return hard_syndrome(s,p);
+  }
+				/* row processing */
+  for (m = 0; m <= s->M-1; m++) {
+    par = 0;
+    for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++) 
+      par ^= p->hd_q[e];
+    for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++) 
+      p->hd_r[e] = par ^ p->hd_q[e];
+  }
+				/* column processing */
+  for (n = 0; n <= s->N-1; n++) {
+    edge = s->col_edge + s->col_start[n];
+    d = s->num_ones_in_col[n];
+    ch = p->hd_ch[n];
+    for (j = 0; j <= p->hd_planes-1; j++) c[j] = 0;
+    for (i = 0; i <= d-1; i++) hd_add(c,p->hd_planes,p->hd_r[edge[i]] ^ ch);
+				/* b of the d-1 other checks */
+    b = (p->algorithm == ALG_GALA) ? d-1 : (d-1)/2+1;
+    if (b < 1) b = 1;
+    flip = hd_at_least(c,p->hd_planes,b);
+    flip1 = hd_at_least(c,p->hd_planes,b+1);
+    for (i = 0; i <= d-1; i++) {
+      own = p->hd_r[edge[i]] ^ ch;
+      p->hd_q[edge[i]] = ch ^ ((own & flip1) | (~own & flip));
+    }
+    p->hd_dec[n] = ch ^ hd_at_least(c,p->hd_planes,(d+1)/2+1);
+  }
+  return hard_syndrome(s,p);
+}
+
+/* ================================================== */
+/*  Hard-decision decoder of one frame (lane 0)       */
+/*  return value = 0: success                         */
+/*  return value = 1: failure                         */
+/* ================================================== */
+
+int hard_decoder(sparce_matrix* s, simulation_parameters* param)
+{
+  int i,n;
+
+  init_syndrome(s,param);
+  load_hard(s,param,0);
+  for (i = 1; i <= param->max_iteration; i++) {
+    param->error_weight_in_word = 0;
+    param->num_iteration++;
+    hard_iteration(s,param);
+    for (n = 0; n <= s->N-1; n++) 
+      bit_decision(s,param,n,(int)(param->hd_dec[n] & 1));
+    if (parity_check(s,param) == 0) return 0;
+    if (abandon_frame(param,i)) return 1;
+  }
+  return 1;
+}
+
+/* ================================================== */
+/*  Float and double decoders on the same received    */
+/*  word. The result of the double decoder is used    */
+/*  for the simulation; the float decoder is counted  */
+/*  in the cmp_* fields.                              */
+/* ================================================== */
+
+int compare_decoder(sparce_matrix* s, simulation_parameters* param)
+{
+  int n,diff,ret;
+  int weight,abandoned;
+  long long iteration,ablks,abitr;
+
+  iteration = param->num_iteration;
+  ablks = param->abandoned_blocks;
+  abitr = param->abandoned_iterations;
+  param->error_weight_in_word = 0;
+  decoder32(s,param);
+  param->cmp_num_iteration += param->num_iteration - iteration;
+  param->num_iteration = iteration;
+  weight = param->error_weight_in_word;
+  abandoned = param->abandoned;	/* abandonment of double is reported */
+  param->abandoned_blocks = ablks;
+  param->abandoned_iterations = abitr;
+  memcpy(param->cmp_decision,param->tmp_decision,sizeof(int)*param->N);
+
+  ret = decoder64(s,param);
+  
+  diff = 0;
+  for (n = 0; n <= param->N-1; n++) 
+    diff += (param->cmp_decision[n] != param->tmp_decision[n]);
+  if ((weight != 0) || abandoned) param->cmp_error_blocks++;
+  param->cmp_error_bits += weight;
+  if (diff != 0) param->cmp_differ_blocks++;
+  param->cmp_differ_bits += diff;
+  return ret;
+}
+
+/* ================================================== */
+/*  Channel metrics for the floating point decoders;  */
+/*  called once per frame after awgn_channel. The     */
+/*  quantized decoders quantize the LLR themselves,   */
+/*  the hard-decision decoders take the sign.         */
+/* ================================================== */
+
+void channel_metrics(sparce_matrix* s, simulation_parameters* param)
+{
+  if ((param->qbits > 0) || (param->algorithm >= ALG_GALA)) return;
+  if (param->precision != PREC_FLOAT) channel_metrics64(s,param);
+  if (param->precision != PREC_DOUBLE) channel_metrics32(s,param);
+}
+
+/* ================================================== */
+/*  decoder selected by param->algorithm              */
+/* ================================================== */
+
+int decoder(sparce_matrix* s, simulation_parameters* param)
+{
+  if (param->qbits > 0) {
+    if ((param->qbits <= 8) && (param->qch_bits <= 8)) 
+      return q_decoder8(s,param);
+    else
+      return q_decoder16(s,param);
+  }
+  if (param->algorithm >= ALG_GALA) return hard_decoder(s,param);
+  if (param->precision == PREC_FLOAT) return decoder32(s,param);
+  if (param->precision == PREC_COMPARE) return compare_decoder(s,param);
+  return decoder64(s,param);
+}
+
+/* ================================================== */
+/*  Counters of the simulation results                */
+/* ================================================== */
+
+void clear_counters(simulation_parameters* param)
+{
+  param->total_blocks = 0;
+  param->error_blocks = 0;
+  param->total_bits = 0;
+  param->error_bits = 0;
+  param->error_bits2 = 0.0;
+  param->num_iteration = 0;
+  param->cmp_error_blocks = 0;
+  param->cmp_error_bits = 0;
+  param->cmp_num_iteration = 0;
+  param->cmp_differ_blocks = 0;
+  param->cmp_differ_bits = 0;
+  param->abandoned_blocks = 0;
+  param->abandoned_iterations = 0;
+  param->is_blocks = param->is_blocks2 = 0.0;
+  param->is_bits = param->is_bits2 = 0.0;
+}
+
+/* The counters of a worker are added to those of param. */
+
+void merge_counters(simulation_parameters* param, simulation_parameters* w)
+{
+  param->total_blocks += w->total_blocks;
+  param->error_blocks += w->error_blocks;
+  param->total_bits += w->total_bits;
+  param->error_bits += w->error_bits;
+  param->error_bits2 += w->error_bits2;
+  param->num_iteration += w->num_iteration;
+  param->cmp_error_blocks += w->cmp_error_blocks;
+  param->cmp_error_bits += w->cmp_error_bits;
+  param->cmp_num_iteration += w->cmp_num_iteration;
+  param->cmp_differ_blocks += w->cmp_differ_blocks;
+  param->cmp_differ_bits += w->cmp_differ_bits;
+  param->abandoned_blocks += w->abandoned_blocks;
+  param->abandoned_iterations += w->abandoned_iterations;
+  param->is_blocks += w->is_blocks;
+  param->is_blocks2 += w->is_blocks2;
+  param->is_bits += w->is_bits;
+  param->is_bits2 += w->is_bits2;
+}
+
+/* The counters as one line of a checkpoint, and back; */
+/* read_counters returns 0 on a short line. */
+
+void write_counters(FILE* fp, simulation_parameters* p)
+{
+  fprintf(fp,"%lld %lld %lld %lld %.17g %lld ",
+	  p->total_blocks,p->error_blocks,p->total_bits,p->error_bits,
+	  p->error_bits2,p->num_iteration);
+  fprintf(fp,"%lld %lld %lld %lld %lld %lld %lld ",
+	  p->cmp_error_blocks,p->cmp_error_bits,p->cmp_num_iteration,
+	  p->cmp_differ_blocks,p->cmp_differ_bits,
+	  p->abandoned_blocks,p->abandoned_iterations);
+  fprintf(fp,"%.17g %.17g %.17g %.17g\n",
+	  p->is_blocks,p->is_blocks2,p->is_bits,p->is_bits2);
+}
+
+int read_counters(FILE* fp, simulation_parameters* p)
+{
+  return (fscanf(fp,"%lld %lld %lld %lld %lf %lld",
+		 &p->total_blocks,&p->error_blocks,&p->total_bits,
+		 &p->error_bits,&p->error_bits2,&p->num_iteration) == 6)
+    && (fscanf(fp,"%lld %lld %lld %lld %lld %lld %lld",
+	       &p->cmp_error_blocks,&p->cmp_error_bits,&p->cmp_num_iteration,
+	       &p->cmp_differ_blocks,&p->cmp_differ_bits,
+	       &p->abandoned_blocks,&p->abandoned_iterations) == 7)
+    && (fscanf(fp,"%lf %lf %lf %lf",
+	       &p->is_blocks,&p->is_blocks2,&p->is_bits,&p->is_bits2) == 4);
+}
+
+/* ================================================== */
+/*  Initialization on simulation parameters           */
+/* ================================================== */
+
+void init_simulation_param(sparce_matrix* s, simulation_parameters* param)
+{
+  param->N = s->N;
+  param->M = s->M;
+  clear_counters(param);
+
+  if ((param->rword = (double*)malloc(sizeof(double)*param->N)) == NULL) {
     fprintf(stderr,"Can't allocate memory\n");
     exit(-1);
   }
 
-  if ((param->ud_upward1
-       = (double*)malloc(sizeof(double)*(s->biggest_num_ones_col+1))) 
+  param->qr8 = param->qq8 = param->qch8 = NULL;
+  param->qr16 = param->qq16 = param->qch16 = NULL;
+  if ((param->qbits > 0) && (param->qbits <= 8) && (param->qch_bits <= 8)) {
+    if (((param->qr8 = (signed char*)malloc(s->num_edges)) == NULL)
+	|| ((param->qq8 = (signed char*)malloc(s->num_edges)) == NULL)
+	|| ((param->qch8 = (signed char*)malloc(s->N)) == NULL)) {
+      fprintf(stderr,"Can't allocate memory\n");
+      exit(-1);
+    }
+  }
+  else if (param->qbits > 0) {
+    if (((param->qr16 = (short*)malloc(sizeof(short)*s->num_edges)) == NULL)
+	|| ((param->qq16 = (short*)malloc(sizeof(short)*s->num_edges)) == NULL)
+	|| ((param->qch16 = (short*)malloc(sizeof(short)*s->N)) == NULL)) {
+      fprintf(stderr,"Can't allocate memory\n");
+      exit(-1);
+    }
+  }
+  else if (param->algorithm >= ALG_GALA) {
+    if (((param->hd_ch = (uint64_t*)calloc(s->N,sizeof(uint64_t))) == NULL)
+	|| ((param->hd_q = (uint64_t*)calloc(s->num_edges,sizeof(uint64_t))) == NULL)
+	|| ((param->hd_r = (uint64_t*)calloc(s->num_edges,sizeof(uint64_t))) == NULL)
+	|| ((param->hd_dec = (uint64_t*)calloc(s->N,sizeof(uint64_t))) == NULL)
+	|| ((param->hd_syn = (uint64_t*)calloc(s->M,sizeof(uint64_t))) == NULL)) {
+      fprintf(stderr,"Can't allocate memory\n");
+      exit(-1);
+    }
+    param->hd_planes = 1;
+    while ((s->biggest_num_ones_col >> param->hd_planes) != 0) 
+      param->hd_planes++;
+  }
+  else {
+    if (param->schedule == SCHED_LAYERED) init_layers(s,param);
+    if (param->precision != PREC_FLOAT) alloc_workspace64(s,param);
+    if (param->precision != PREC_DOUBLE) alloc_workspace32(s,param);
+  }
+
+  if ((param->tmp_decision
+       = (int*)malloc(sizeof(int)*param->N)) 
       == NULL) {
     fprintf(stderr,"Can't allocate memory\n");
     exit(-1);
   }
 
-  if ((param->ud_downward0
-       = (double*)malloc(sizeof(double)*(s->biggest_num_ones_col+1))) 
+  if ((param->syndrome
+       = (int*)malloc(sizeof(int)*param->M)) 
       == NULL) {
     fprintf(stderr,"Can't allocate memory\n");
     exit(-1);
   }
 
-  if ((param->ud_downward1
-       = (double*)malloc(sizeof(double)*(s->biggest_num_ones_col+1))) 
+  if ((param->cmp_decision
+       = (int*)malloc(sizeof(int)*param->N)) 
       == NULL) {
     fprintf(stderr,"Can't allocate memory\n");
     exit(-1);
   }
+}
 
-  if ((param->ud_tmp0
-       = (double*)malloc(sizeof(double)*(s->biggest_num_ones_col+1))) 
-      == NULL) {
-    fprintf(stderr,"Can't allocate memory\n");
+/* ================================================== */
+/*  Count error blocks and bits                       */
+/* ================================================== */
+
+void error_count(simulation_parameters* param)
+{
+  double w;
+
+				/* a given up frame is an error block */
+  if ((param->error_weight_in_word != 0) || param->abandoned) 
+    param->error_blocks++;
+  param->error_bits += param->error_weight_in_word;
+  param->error_bits2 += (double)param->error_weight_in_word 
+    * param->error_weight_in_word;
+
+  if (param->is_method != IS_OFF) { /* weighted counts */
+    w = param->is_weight;
+    if ((param->error_weight_in_word != 0) || param->abandoned) {
+      param->is_blocks += w;
+      param->is_blocks2 += w * w;
+    }
+    w *= param->error_weight_in_word;
+    param->is_bits += w;
+    param->is_bits2 += w * w;
+  }
+}
+
+/* ================================================== */
+/*  Frame-parallel simulation (-j) of a sweep of SNR  */
+/*  points                                            */
+/*  Every worker owns a simulation_parameters with    */
+/*  its workspace, random number stream and counters; */
+/*  only the matrix is shared. The frames of a point  */
+/*  are numbered, and batch b is the frames b*batch   */
+/*  ... (b+1)*batch-1. A worker takes the next batch  */
+/*  of its point, decodes it and puts its counters    */
+/*  into the ring of the point. The batches are added */
+/*  to the result of the point in the order of their  */
+/*  numbers, and the point is finished at the end of  */
+/*  the first batch that reaches #err. With -rng      */
+/*  philox the noise of a frame depends only on the   */
+/*  seed, the SNR and the frame number (see           */
+/*  init_frame_rng), so the results do not depend on  */
+/*  the number of workers. When a point is finished,  */
+/*  its workers move to the unfinished point with the */
+/*  fewest workers, so that the workers gather on the */
+/*  slow (high SNR) points at the end of a sweep.     */
+/*  Workers and points are cache line aligned, so     */
+/*  that the data of different threads never share a  */
+/*  line.                                             */
+/* ================================================== */
+
+typedef struct _POINT
+{
+  _Alignas(CACHE_LINE) atomic_int stop;	/* 1: the point is finished */
+  int workers;			/* workers on the point (sweep lock) */
+  long long next_batch;		/* next batch to be decoded */
+  long long committed;		/* batches 0 ... committed-1 are counted */
+  int ring_size;		/* batches decoded ahead of committed */
+  simulation_parameters* ring;	/* counters of batch b in b % ring_size */
+  int* ring_done;		/* 1: the counters of the slot are ready */
+  pthread_mutex_t lock;		/* for all of the above and result */
+  pthread_cond_t cond;		/* a batch was counted */
+  double start;			/* wall-clock time of the first batch */
+  simulation_parameters result;	/* snr, var and counters of the point */
+} sweep_point;
+
+typedef struct _SWEEP
+{
+  int num_points;
+  sweep_point* point;
+  int batch;			/* frames per batch */
+  pthread_mutex_t lock;		/* assignment of workers to points */
+  pthread_mutex_t ck_lock;	/* writer of the checkpoint */
+  double ck_last;		/* wall-clock time of the last one */
+} sweep_state;
+
+/* set by SIGINT and SIGTERM; the workers leave after */
+/* the current frame and main prints what is counted */
+
+static atomic_int interrupted;
+
+void on_signal(int sig)
+{
+  atomic_store(&interrupted,1);
+}
+
+typedef struct _WORKER
+{
+  _Alignas(CACHE_LINE) simulation_parameters param;
+  sparce_matrix* s;		/* parity check matrix (shared) */
+  sweep_state* sweep;
+  int current;			/* point of the worker (-1: none) */
+  pthread_t thread;
+  struct _PIPE* pipe;		/* producer of the frames (-pipe) */
+  struct _LANES* lanes;		/* lanes of the frames (-lanes) */
+} worker;
+
+/* one frame: channel, decoding and error count */
+
+void channel_frame(sparce_matrix* s, simulation_parameters* param)
+{
+  awgn_channel(s,param);
+}
+
+void decode_frame(sparce_matrix* s, simulation_parameters* param)
+{
+  param->total_blocks++;
+  param->total_bits += param->N;
+
+  channel_metrics(s,param);
+  decoder(s,param);
+  error_count(param);
+}
+
+void simulate_frame(sparce_matrix* s, simulation_parameters* param)
+{
+  channel_frame(s,param);
+  decode_frame(s,param);
+}
+
+/* ================================================== */
+/*  Stop rules of a point with the counters r, after  */
+/*  each counted batch: #err errors (bits for stop =  */
+/*  0, blocks for stop = 1) and, with -ci, a relative */
+/*  half width of the interval of at most ci_width;   */
+/*  -maxframes and -time end a point in any case.     */
+/* ================================================== */
+
+double wall_time(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+int point_finished(simulation_parameters* r, double start)
+{
+  double mean,var;
+  long long errors;
+
+  if ((r->max_frames > 0) && (r->total_blocks >= r->max_frames)) return 1;
+  if ((r->time_budget > 0) && (wall_time() - start >= r->time_budget)) 
+    return 1;
+  errors = (r->stop == 0) ? r->error_bits : r->error_blocks;
+  if (errors < r->stop_err) return 0;
+  if (r->ci_width <= 0) return 1;
+  error_rate(r,r->stop == 0,r->is_method != IS_OFF,&mean,&var);
+  return (mean > 0) && (CI_Z * sqrt(var) <= r->ci_width * mean);
+}
+
+/* ================================================== */
+/*  The worker leaves point cur (-1: none) and joins  */
+/*  the unfinished point with the fewest workers.     */
+/*  return value = the point, -1 if all are finished  */
+/* ================================================== */
+
+int next_point(sweep_state* sw, int cur)
+{
+  int i,best;
+
+  pthread_mutex_lock(&sw->lock);
+  if (cur >= 0) sw->point[cur].workers--;
+  best = -1;
+  for (i = 0; i <= sw->num_points-1; i++) {
+    if (atomic_load(&sw->point[i].stop)) continue;
+    if ((best < 0) || (sw->point[i].workers < sw->point[best].workers)) 
+      best = i;
+  }
+  if (best >= 0) sw->point[best].workers++;
+  pthread_mutex_unlock(&sw->lock);
+  return best;
+}
+
+/* ================================================== */
+/*  Checkpoints (-checkpoint, -resume)                */
+/*  A checkpoint holds, for each SNR point, the       */
+/*  number of counted batches and the counters. With  */
+/*  -rng philox the frames of batch b depend only on  */
+/*  b (init_frame_rng), so this is the whole random   */
+/*  number state: a resumed run decodes the same      */
+/*  frames as one that was never stopped. The batches */
+/*  in flight are decoded again. The file is written  */
+/*  as file.tmp and renamed, so that a kill during    */
+/*  the write leaves the previous checkpoint.         */
+/*  The header line holds the options that change the */
+/*  results (run_options); a run with other options   */
+/*  or a smaller #err can't resume the checkpoint.    */
+/* ================================================== */
+
+/* the decoder and statistics options of a run as text */
+
+void run_options(char* buf, int size, simulation_parameters* p)
+{
+  snprintf(buf,size,"alg %d alpha %.17g beta %.17g maxi %d stop %d "
+	   "q %d qch %d qstep %.17g prec %d sched %d layers %s cgroup %d "
+	   "abandon %d is %d isbias %.17g file %s",
+	   p->algorithm,p->ms_scale,p->ms_offset,p->max_iteration,p->stop,
+	   p->qbits,p->qch_bits,p->qstep,p->precision,p->schedule,
+	   (p->layer_file != NULL) ? p->layer_file : "-",p->col_group,
+	   p->abandon_window,p->is_method,p->is_bias,p->file);
+}
+
+void write_checkpoint(sweep_state* sw, simulation_parameters* param)
+{
+  FILE* fp;
+  char tmp[FILENAME_MAX];
+  char options[MAX_OPTIONS];
+  simulation_parameters r;
+  long long committed;
+  int i;
+
+  snprintf(tmp,sizeof(tmp),"%s.tmp",param->ck_file);
+  if ((fp = fopen(tmp,"w")) == NULL) {
+    fprintf(stderr,"Can't open %s.\n",tmp);
+    return;
+  }
+  run_options(options,sizeof(options),param);
+  fprintf(fp,"#checkpoint awgniterative %d %d %d %d %d %d %d %d %s\n",
+	  param->N,param->M,param->seed,sw->batch,sw->num_points,
+	  param->shard,param->num_shards,param->stop_err,options);
+  for (i = 0; i <= sw->num_points-1; i++) {
+    pthread_mutex_lock(&sw->point[i].lock);
+    r = sw->point[i].result;
+    committed = sw->point[i].committed;
+    pthread_mutex_unlock(&sw->point[i].lock);
+    fprintf(fp,"%.17g %lld ",r.snr,committed);
+    write_counters(fp,&r);
+  }
+  if ((fclose(fp) != 0) || (rename(tmp,param->ck_file) != 0)) 
+    fprintf(stderr,"Can't write %s.\n",param->ck_file);
+}
+
+void read_checkpoint(sweep_state* sw, simulation_parameters* param)
+{
+  FILE* fp;
+  char prog[32];
+  char options[MAX_OPTIONS],line[MAX_OPTIONS];
+  int i,n,m,seed,batch,points,shard,num_shards,stop_err;
+  double snr;
+  long long committed;
+  sweep_point* pt;
+
+  if ((fp = fopen(param->resume_file,"r")) == NULL) {
+    fprintf(stderr,"Can't open %s.\n",param->resume_file);
+    exit(-1);
+  }
+  run_options(options,sizeof(options),param);
+  if ((fscanf(fp,"#checkpoint %31s %d %d %d %d %d %d %d %d ",
+	      prog,&n,&m,&seed,&batch,&points,&shard,&num_shards,
+	      &stop_err) != 9)
+      || (fgets(line,sizeof(line),fp) == NULL)
+      || (strcspn(line,"\n") != strlen(options))
+      || (strncmp(line,options,strlen(options)) != 0)
+      || (stop_err > param->stop_err)
+      || (strcmp(prog,"awgniterative") != 0) || (n != param->N) || (m != param->M)
+      || (seed != param->seed) || (batch != sw->batch) 
+      || (points != sw->num_points) || (shard != param->shard)
+      || (num_shards != param->num_shards)) {
+    fprintf(stderr,"Checkpoint %s does not match this run.\n",
+	    param->resume_file);
     exit(-1);
   }
+  for (i = 0; i <= sw->num_points-1; i++) {
+    pt = &sw->point[i];
+    if ((fscanf(fp,"%lf %lld",&snr,&committed) != 2)
+	|| (fabs(snr - pt->result.snr) > 1e-9)
+	|| !read_counters(fp,&pt->result)) {
+      fprintf(stderr,"Checkpoint %s does not match this run.\n",
+	      param->resume_file);
+      exit(-1);
+    }
+    pt->committed = pt->next_batch = committed;
+				/* a larger #err goes on with a point */
+    pt->start = wall_time();
+    atomic_store(&pt->stop,point_finished(&pt->result,pt->start));
+  }
+  fclose(fp);
+}
 
-  if ((param->ud_tmp1
-       = (double*)malloc(sizeof(double)*(s->biggest_num_ones_col+1))) 
-      == NULL) {
+/* ================================================== */
+/*  Record of a shard (-shard, -shardout) for         */
+/*  mergeshards: a line "#shard program K S batch"    */
+/*  with the options of run_options and, for each     */
+/*  point, snr var seed maxi N M file                 */
+/*  stop #err, the number of counted batches and the  */
+/*  counters (as in a checkpoint)                     */
+/* ================================================== */
+
+void write_shard_record(sweep_state* sw, simulation_parameters* param,
+			char* file)
+{
+  FILE* fp;
+  simulation_parameters* r;
+  char options[MAX_OPTIONS];
+  int i;
+
+  if ((fp = fopen(param->shard_file,"w")) == NULL) {
+    fprintf(stderr,"Can't open %s.\n",param->shard_file);
+    return;
+  }
+  run_options(options,sizeof(options),param);
+  fprintf(fp,"#shard awgniterative %d %d %d %s\n",
+	  param->shard,param->num_shards,sw->batch,options);
+  for (i = 0; i <= sw->num_points-1; i++) {
+    r = &sw->point[i].result;
+    fprintf(fp,"%.17g %.17g %d %d %d %d %s %d %d %lld ",
+	    r->snr,r->var,r->seed,r->max_iteration,r->N,r->M,file,
+	    r->stop,r->stop_err,sw->point[i].committed);
+    write_counters(fp,r);
+  }
+  if (fclose(fp) != 0) fprintf(stderr,"Can't write %s.\n",param->shard_file);
+}
+
+/* ================================================== */
+/*  A batch of point pt for a worker; at most         */
+/*  ring_size batches ahead of the counted ones.      */
+/*  return value = the batch, -1 if interrupted       */
+/* ================================================== */
+
+long long claim_batch(sweep_point* pt)
+{
+  long long b;
+
+  pthread_mutex_lock(&pt->lock);
+  while (!atomic_load(&pt->stop) && !atomic_load(&interrupted)
+	 && (pt->next_batch - pt->committed >= pt->ring_size)) 
+    pthread_cond_wait(&pt->cond,&pt->lock);
+  if (atomic_load(&interrupted)) {
+    pthread_mutex_unlock(&pt->lock);
+    return -1;
+  }
+  b = pt->next_batch++;
+  if (b == 0) pt->start = wall_time();
+  pthread_mutex_unlock(&pt->lock);
+  return b;
+}
+
+/* ================================================== */
+/*  The counters of the worker for batch b go to the  */
+/*  ring of point pt if the batch is complete; the    */
+/*  batches are counted in order. Then the periodic   */
+/*  checkpoint.                                       */
+/* ================================================== */
+
+void commit_batch(worker* w, sweep_point* pt, long long b, int complete)
+{
+  simulation_parameters* p = &w->param;
+  int k;
+
+  pthread_mutex_lock(&pt->lock);
+  if (!atomic_load(&pt->stop) && complete) {
+    k = b % pt->ring_size;
+    clear_counters(&pt->ring[k]);
+    merge_counters(&pt->ring[k],p);
+    pt->ring_done[k] = 1;
+  }
+  while (!atomic_load(&pt->stop) && pt->ring_done[k = pt->committed % pt->ring_size]) {
+    merge_counters(&pt->result,&pt->ring[k]);
+    pt->ring_done[k] = 0;
+    pt->committed++;
+    if (p->display == 1) print_results(stderr,"****",&pt->result);
+    if (point_finished(&pt->result,pt->start)) atomic_store(&pt->stop,1);
+  }
+  pthread_cond_broadcast(&pt->cond);
+  pthread_mutex_unlock(&pt->lock);
+  clear_counters(p);
+  if (atomic_load(&interrupted)) return;
+
+  if ((p->ck_file != NULL) 
+      && (pthread_mutex_trylock(&w->sweep->ck_lock) == 0)) {
+    if (wall_time() - w->sweep->ck_last >= p->ck_interval) {
+      write_checkpoint(w->sweep,p);
+      w->sweep->ck_last = wall_time();
+    }
+    pthread_mutex_unlock(&w->sweep->ck_lock);
+  }
+}
+
+/* ================================================== */
+/*  Pipelined simulation (-pipe D)                    */
+/*  Each worker has a producer thread that claims the */
+/*  batches and makes the received words into a       */
+/*  single-producer/single-consumer ring of D slots;  */
+/*  the worker decodes and counts them. head and tail */
+/*  are the only shared variables (on lines of their  */
+/*  own): a slot is written before head is released   */
+/*  and read before tail is released, so no lock is   */
+/*  taken per frame. A PIPE_BATCH slot ends a batch   */
+/*  (complete = 0 if the producer cut it short) and   */
+/*  PIPE_END ends the work of the worker. A full or   */
+/*  empty ring yields the processor.                  */
+/* ================================================== */
+
+#define PIPE_FRAME 0		/* a received word */
+#define PIPE_BATCH 1		/* end of a batch */
+#define PIPE_END   2		/* end of the producer */
+
+typedef struct _PIPE_SLOT
+{
+  int kind;			/* PIPE_FRAME, PIPE_BATCH or PIPE_END */
+  int point;			/* point of the frame */
+  long long batch;
+  long long frame;		/* frame number (PIPE_FRAME) */
+  int complete;			/* 1: all frames of the batch (PIPE_BATCH) */
+  double is_weight;		/* likelihood ratio of -is */
+  double* rword;		/* received word */
+} pipe_slot;
+
+typedef struct _PIPE
+{
+  _Alignas(CACHE_LINE) atomic_llong head; /* slots written by the producer */
+  _Alignas(CACHE_LINE) atomic_llong tail; /* slots read by the worker */
+  _Alignas(CACHE_LINE) int size;	/* number of slots */
+  pipe_slot* slot;
+  simulation_parameters prod;	/* random numbers of the producer */
+  pthread_t thread;
+} pipe_ring;
+
+/* the next slot to write (waits for a free one) */
+
+pipe_slot* pipe_reserve(pipe_ring* r)
+{
+  long long h = atomic_load_explicit(&r->head,memory_order_relaxed);
+
+  while (h - atomic_load_explicit(&r->tail,memory_order_acquire) >= r->size)
+    sched_yield();
+  return &r->slot[h % r->size];
+}
+
+void pipe_push(pipe_ring* r)
+{
+  atomic_store_explicit(&r->head,
+	atomic_load_explicit(&r->head,memory_order_relaxed) + 1,
+	memory_order_release);
+}
+
+/* the next slot to read (waits for a written one) */
+
+pipe_slot* pipe_front(pipe_ring* r)
+{
+  long long t = atomic_load_explicit(&r->tail,memory_order_relaxed);
+
+  while (atomic_load_explicit(&r->head,memory_order_acquire) == t)
+    sched_yield();
+  return &r->slot[t % r->size];
+}
+
+void pipe_pop(pipe_ring* r)
+{
+  atomic_store_explicit(&r->tail,
+	atomic_load_explicit(&r->tail,memory_order_relaxed) + 1,
+	memory_order_release);
+}
+
+void init_pipe(worker* w, int depth, int k)
+{
+  pipe_ring* r;
+  int i;
+
+  if (((r = (pipe_ring*)aligned_alloc(CACHE_LINE,sizeof(pipe_ring))) == NULL)
+      || ((r->slot = (pipe_slot*)malloc(sizeof(pipe_slot)*depth)) == NULL)) {
     fprintf(stderr,"Can't allocate memory\n");
     exit(-1);
   }
+  for (i = 0; i <= depth-1; i++) {
+    if ((r->slot[i].rword = (double*)malloc(sizeof(double)*w->param.N)) == NULL) {
+      fprintf(stderr,"Can't allocate memory\n");
+      exit(-1);
+    }
+  }
+  atomic_init(&r->head,0);
+  atomic_init(&r->tail,0);
+  r->size = depth;
+  r->prod = w->param;		/* the stream of worker k */
+  init_rng(&r->prod,k);
+  w->pipe = r;
+}
 
-  if ((param->tmp_q0
-       = (double*)malloc(sizeof(double)*s->N)) 
-      == NULL) {
-    fprintf(stderr,"Can't allocate memory\n");
+void* pipe_producer(void* arg)
+{
+  worker* w = (worker*)arg;
+  pipe_ring* r = w->pipe;
+  simulation_parameters* p = &r->prod;
+  sweep_point* pt;
+  pipe_slot* sl;
+  long long b,frame;
+  int i;
+
+  while (w->current >= 0) {
+    pt = &w->sweep->point[w->current];
+    p->snr = pt->result.snr;
+    p->var = pt->result.var;
+    if ((b = claim_batch(pt)) < 0) break;
+    for (i = 0; i <= w->sweep->batch-1; i++) {
+      if (atomic_load_explicit(&pt->stop,memory_order_relaxed)
+	  || atomic_load_explicit(&interrupted,memory_order_relaxed)) break;
+      frame = (b * p->num_shards + p->shard) * w->sweep->batch + i;
+      sl = pipe_reserve(r);
+      if (p->rng_type == RNG_PHILOX) init_frame_rng(p,frame);
+      p->rword = sl->rword;
+      channel_frame(w->s,p);
+      sl->kind = PIPE_FRAME;
+      sl->point = w->current;
+      sl->batch = b;
+      sl->frame = frame;
+      sl->is_weight = p->is_weight;
+      pipe_push(r);
+    }
+    sl = pipe_reserve(r);
+    sl->kind = PIPE_BATCH;
+    sl->point = w->current;
+    sl->batch = b;
+    sl->complete = (i == w->sweep->batch);
+    pipe_push(r);
+    if (atomic_load(&interrupted)) break;
+    if (atomic_load(&pt->stop)) w->current = next_point(w->sweep,w->current);
+  }
+  sl = pipe_reserve(r);
+  sl->kind = PIPE_END;
+  pipe_push(r);
+  return NULL;
+}
+
+/* the worker side of -pipe */
+
+void pipe_decoder(worker* w)
+{
+  simulation_parameters* p = &w->param;
+  pipe_ring* r = w->pipe;
+  double* rword = p->rword;
+  sweep_point* pt;
+  pipe_slot* sl;
+  long long blocks;
+  int skipped = 0;		/* 1: a frame of the batch is skipped */
+
+  if (pthread_create(&r->thread,NULL,pipe_producer,w) != 0) {
+    fprintf(stderr,"Can't create a thread\n");
     exit(-1);
   }
+  while ((sl = pipe_front(r))->kind != PIPE_END) {
+    pt = &w->sweep->point[sl->point];
+    if (sl->kind == PIPE_BATCH) {
+      commit_batch(w,pt,sl->batch,sl->complete && !skipped);
+      skipped = 0;
+    }
+    else if (atomic_load_explicit(&pt->stop,memory_order_relaxed)
+	     || atomic_load_explicit(&interrupted,memory_order_relaxed)) 
+      skipped = 1;
+    else {
+      p->snr = pt->result.snr;
+      p->var = pt->result.var;
+      p->rword = sl->rword;
+      p->is_weight = sl->is_weight;
+      blocks = p->error_blocks;
+      decode_frame(w->s,p);
+      if ((p->display == 1) && (p->error_blocks != blocks)) 
+	fprintf(stderr,"**** error frame %lld (snr %f): %d bits\n",
+		sl->frame,p->snr,p->error_weight_in_word);
+    }
+    pipe_pop(r);
+  }
+  pipe_pop(r);
+  pthread_join(r->thread,NULL);
+  p->rword = rword;
+}
 
-  if ((param->tmp_q1
-       = (double*)malloc(sizeof(double)*s->N)) 
-      == NULL) {
+/* ================================================== */
+/*  Multi-frame decoding of a batch (-lanes)          */
+/*  The frames of batch b go into the lanes of the    */
+/*  workspace in order. After every iteration, a lane */
+/*  whose decision is a codeword or that has had      */
+/*  max_iteration iterations is unloaded and refilled */
+/*  with the next frame, so that no lane idles while  */
+/*  frames of the batch remain. The results of the    */
+/*  frames are counted in the order of their numbers  */
+/*  at the end, as in the loop of simulation_worker.  */
+/*  The lanes are those of the floating point         */
+/*  workspace (LANES(T)) or the HARD_LANES bits of    */
+/*  the hard-decision decoders.                       */
+/* ================================================== */
+
+typedef struct _LANES
+{
+  int lanes;			/* LANES(T) or HARD_LANES */
+  int* frame;			/* frame of the batch in lane l (-1: idle) */
+  int* iteration;		/* iterations of lane l */
+  int* unsatisfied;		/* unsatisfied checks of lane l */
+  int* weight;			/* error bits of frame i of the batch */
+  int* iterations;		/* iterations of frame i */
+  double* is_weight;		/* likelihood ratio of frame i */
+} lane_state;
+
+void init_lanes(worker* w)
+{
+  lane_state* r;
+  int n = w->sweep->batch;
+
+  if ((r = (lane_state*)malloc(sizeof(lane_state))) == NULL) {
     fprintf(stderr,"Can't allocate memory\n");
     exit(-1);
   }
-
-  if ((param->tmp_decision
-       = (int*)malloc(sizeof(int)*param->N)) 
-      == NULL) {
+				/* the words of the hard-decision */
+				/* decoders are in param */
+  if (w->param.algorithm >= ALG_GALA) r->lanes = HARD_LANES;
+  else if (w->param.precision == PREC_FLOAT) {
+    r->lanes = LANES(float);
+    alloc_frames32(w->s,&w->param);
+  }
+  else {
+    r->lanes = LANES(double);
+    alloc_frames64(w->s,&w->param);
+  }
+  if (((r->frame = (int*)malloc(sizeof(int)*r->lanes)) == NULL)
+      || ((r->iteration = (int*)malloc(sizeof(int)*r->lanes)) == NULL)
+      || ((r->unsatisfied = (int*)malloc(sizeof(int)*r->lanes)) == NULL)
+      || ((r->weight = (int*)malloc(sizeof(int)*n)) == NULL)
+      || ((r->iterations = (int*)malloc(sizeof(int)*n)) == NULL)
+      || ((r->is_weight = (double*)malloc(sizeof(double)*n)) == NULL)) {
     fprintf(stderr,"Can't allocate memory\n");
     exit(-1);
   }
+  w->lanes = r;
+}
+
+/* the kernels of the algorithm and precision of p */
+
+void load_lane(sparce_matrix* s, simulation_parameters* p, int l)
+{
+  if (p->algorithm >= ALG_GALA) load_hard(s,p,l);
+  else if (p->precision == PREC_FLOAT) load_lane32(s,p,l);
+  else load_lane64(s,p,l);
+}
+
+void unload_lane(sparce_matrix* s, simulation_parameters* p, int l)
+{
+  if (p->algorithm >= ALG_GALA) unload_hard(s,p,l);
+  else if (p->precision == PREC_FLOAT) unload_lane32(s,p,l);
+  else unload_lane64(s,p,l);
+}
+
+void lane_iteration(sparce_matrix* s, simulation_parameters* p, 
+		    int* unsatisfied, int lanes)
+{
+  uint64_t u;
+  int l;
+
+  if (p->algorithm >= ALG_GALA) {
+    u = hard_iteration(s,p);
+    for (l = 0; l <= lanes-1; l++) unsatisfied[l] = (u >> l) & 1;
+  }
+  else if (p->precision == PREC_FLOAT) lane_iteration32(s,p,unsatisfied);
+  else lane_iteration64(s,p,unsatisfied);
+}
+
+/* return value = number of frames, 0 if the point is */
+/* finished or the run interrupted during the batch */
+
+int lane_batch(worker* w, sweep_point* pt, long long b)
+{
+  simulation_parameters* p = &w->param;
+  lane_state* r = w->lanes;
+  int batch = w->sweep->batch;
+  int i,l,n,next,active,ref;
+  long long frame,blocks;
+
+  for (l = 0; l <= r->lanes-1; l++) r->frame[l] = -1;
+  next = active = 0;
+  while (1) {
+				/* refilling the idle lanes */
+    for (l = 0; (l <= r->lanes-1) && (next <= batch-1); l++) {
+      if (r->frame[l] >= 0) continue;
+      if (atomic_load_explicit(&pt->stop,memory_order_relaxed)
+	  || atomic_load_explicit(&interrupted,memory_order_relaxed)) {
+	return 0;
+      }
+      frame = (b * p->num_shards + p->shard) * batch + next;
+      if (p->rng_type == RNG_PHILOX) init_frame_rng(p,frame);
+      channel_frame(w->s,p);
+      channel_metrics(w->s,p);
+      load_lane(w->s,p,l);
+      r->is_weight[next] = p->is_weight;
+      r->frame[l] = next++;
+      r->iteration[l] = 0;
+      active++;
+    }
+    if (active == 0) break;
+    lane_iteration(w->s,p,r->unsatisfied,r->lanes);
+				/* unloading the decoded lanes */
+    for (l = 0; l <= r->lanes-1; l++) {
+      if (r->frame[l] < 0) continue;
+      r->iteration[l]++;
+      if ((r->unsatisfied[l] != 0) && (r->iteration[l] < p->max_iteration)) 
+	continue;
+      unload_lane(w->s,p,l);
+      i = r->frame[l];
+      r->iterations[i] = r->iteration[l];
+      r->weight[i] = 0;
+      for (n = 0; n <= p->N-1; n++) {
+	ref = reference_bit(w->s,p,n);
+	if ((ref >= 0) && (p->tmp_decision[n] != ref)) r->weight[i]++;
+      }
+      r->frame[l] = -1;
+      active--;
+    }
+  }
+				/* counting in the order of the frames */
+  for (i = 0; i <= batch-1; i++) {
+    p->total_blocks++;
+    p->total_bits += p->N;
+    p->num_iteration += r->iterations[i];
+    p->error_weight_in_word = r->weight[i];
+    p->is_weight = r->is_weight[i];
+    p->abandoned = 0;
+    blocks = p->error_blocks;
+    error_count(p);
+    if ((p->display == 1) && (p->error_blocks != blocks)) 
+      fprintf(stderr,"**** error frame %lld (snr %f): %d bits\n",
+	      (b * p->num_shards + p->shard) * batch + i,p->snr,
+	      p->error_weight_in_word);
+  }
+  return batch;
+}
+
+void* simulation_worker(void* arg)
+{
+  worker* w = (worker*)arg;
+  simulation_parameters* p = &w->param;
+  sweep_point* pt;
+  int i;
+  long long b,frame,blocks;
+
+  if (w->pipe != NULL) {
+    pipe_decoder(w);
+    return NULL;
+  }
+  while (w->current >= 0) {
+    pt = &w->sweep->point[w->current];
+    p->snr = pt->result.snr;
+    p->var = pt->result.var;
+    if ((b = claim_batch(pt)) < 0) break;
+
+    if (w->lanes != NULL) i = lane_batch(w,pt,b);
+    else for (i = 0; i <= w->sweep->batch-1; i++) {
+      if (atomic_load_explicit(&pt->stop,memory_order_relaxed)
+	  || atomic_load_explicit(&interrupted,memory_order_relaxed)) break;
+      frame = (b * p->num_shards + p->shard) * w->sweep->batch + i;
+      if (p->rng_type == RNG_PHILOX) init_frame_rng(p,frame);
+      blocks = p->error_blocks;
+      simulate_frame(w->s,p);
+      if ((p->display == 1) && (p->error_blocks != blocks)) 
+	fprintf(stderr,"**** error frame %lld (snr %f): %d bits\n",
+		frame,p->snr,p->error_weight_in_word);
+    }
+				/* counting the complete batches */
+				/* in order */
+    commit_batch(w,pt,b,i == w->sweep->batch);
+    if (atomic_load(&interrupted)) break;
+    if (atomic_load(&pt->stop)) w->current = next_point(w->sweep,w->current);
+  }
+  return NULL;
 }
 
 /* ================================================== */
-/*  Count error blocks and bits                       */
+/*  Replay of frame number frame of point pt alone,   */
+/*  with a trace of the iterations (-replay)          */
 /* ================================================== */
 
-void error_count(simulation_parameters* param)
+void replay_frame(worker* w, sweep_point* pt, long long frame, char* file)
 {
-  int i;
+  simulation_parameters* p = &w->param;
+  int n;
+  long long iteration;
+
+  p->snr = pt->result.snr;
+  p->var = pt->result.var;
+  p->trace = 1;
+  clear_counters(p);
+  init_frame_rng(p,frame);
+  printf("#replay: frame %lld snr %f\n",frame,p->snr);
+  simulate_frame(w->s,p);
+  iteration = p->num_iteration;
+  if (p->precision == PREC_COMPARE) iteration += p->cmp_num_iteration;
+  printf("#replay: %s after %lld iterations, %d error bits\n",
+	 p->abandoned ? "abandoned" 
+	 : ((p->unsatisfied == 0) ? "codeword" : "not a codeword"),
+	 iteration,p->error_weight_in_word);
+  printf("#replay: error bits:");
+  for (n = 0; n <= p->N-1; n++) {
+    if ((reference_bit(w->s,p,n) >= 0) 
+	&& (p->tmp_decision[n] != reference_bit(w->s,p,n))) printf(" %d",n);
+  }
+  printf("\n");
+  print_results(stdout,file,p);
+}
 
-  if (param->error_weight_in_word != 0) 
-    param->error_blocks++;
-  param->error_bits += param->error_weight_in_word;
+/* ================================================== */
+/*  SNR points of the snr argument: a value (2.0), a  */
+/*  list (1.0,1.5,2.5) or a range first:step:last     */
+/*  (1.0:0.25:3.0, last included).                    */
+/*  return value = number of points                   */
+/* ================================================== */
+
+int read_snr_list(char* arg, double** snr)
+{
+  int i,num;
+  double first,step,last;
+  char* p;
+
+  if (sscanf(arg,"%lf:%lf:%lf",&first,&step,&last) == 3) {
+    if ((step <= 0) || (last < first)) {
+      fprintf(stderr,"Illegal range of snr %s.\n",arg);
+      exit(-1);
+    }
+    num = (int)floor((last - first)/step + 1e-9) + 1;
+  }
+  else {
+    num = 1;
+    for (p = arg; *p != '\0'; p++) num += (*p == ',');
+  }
+  if ((*snr = (double*)malloc(sizeof(double)*num)) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+  if (strchr(arg,':') != NULL) {
+    for (i = 0; i <= num-1; i++) (*snr)[i] = first + i * step;
+    return num;
+  }
+  p = arg;
+  for (i = 0; i <= num-1; i++) {
+    (*snr)[i] = strtod(p,&p);
+    if (*p == ',') p++;
+  }
+  return num;
 }
 
 
@@ -791,8 +4365,7 @@ parity_check_matrix
 
    */
 
-  int m,i;
-  item* p;
+  int m,i,e;
   printf("%d %d\n",s->N,s->M);
   printf("%d %d\n",s->biggest_num_ones_row,s->biggest_num_ones_col);
   for (i = 0; i <= s->M-1; i++) {
@@ -804,10 +4377,8 @@ parity_check_matrix
   }
   printf("\n");
   for (m = 0; m <= s->M-1; m++) {
-    p = (s->start_row_list[m]).right;
-    for (i = 1; i <= s->num_ones_in_row[m]; i++) {
-      printf("%d ",(p->n)+1);
-      p = p->right;
+    for (e = s->row_start[m]; e <= s->row_start[m+1]-1; e++) {
+      printf("%d ",(s->edge_col[e])+1);
     }
     printf("\n");
   }
@@ -816,8 +4387,8 @@ parity_check_matrix
 
 void print_spmatrix_in_colform(sparce_matrix* s)
 {
-  int n,i;
-  item* p;
+  int n,i,e;
+  int m;
 
   printf("N = %d\n",s->N);
   printf("M = %d\n",s->M);
@@ -838,40 +4409,364 @@ void print_spmatrix_in_colform(sparce_matrix* s)
 
   printf("COLUMN form\n");
   for (n = 0; n <= s->N-1; n++) {
-    p = (s->start_col_list[n]).down;
     printf("%d-th col: ",n);
-    for (i = 1; i <= s->num_ones_in_col[n]; i++) {
-      printf("(%d,%d)->",p->m, p->n);
-      p = p->down;
+    for (i = s->col_start[n]; i <= s->col_start[n+1]-1; i++) {
+      e = s->col_edge[i];
+      for (m = 0; s->row_start[m+1] <= e; m++);
+      printf("(%d,%d)->",m, s->edge_col[e]);
     }
     printf("\n");
   }
 }
 
+/* ================================================== */
+/*  Reading options                                   */
+/*  Options (-name value) are removed from argv and   */
+/*  the number of remaining arguments is returned.    */
+/*  A negative number such as -1.0 is not an option.  */
+/* ================================================== */
+
+int read_options(int argc, char** argv, simulation_parameters* param)
+{
+  int i,k;
+
+  param->algorithm = ALG_PROB;	/* default: original sum-product */
+  param->ms_scale = 0.8;
+  param->ms_offset = 0.15;
+  param->qbits = 0;
+  param->qch_bits = 0;
+  param->qstep = 0.5;
+  param->precision = PREC_DOUBLE;
+  param->simd = 1;
+  param->schedule = SCHED_FLOOD;
+  param->layer_file = NULL;
+  param->col_group = 1;
+  param->abandon_window = 0;
+  param->threads = 1;
+  param->split_threads = 1;
+  param->batch = -1;		/* default: see below */
+  param->pipe_depth = 0;
+  param->frame_lanes = -1;	/* default: see below */
+  param->rng_type = RNG_PHILOX;
+  param->replay = -1;
+  param->trace = 0;
+  param->is_method = IS_OFF;
+  param->is_bias = 0.0;
+  param->ci_width = -1.0;	/* default: see below */
+  param->ck_file = NULL;
+  param->ck_interval = 60.0;
+  param->resume_file = NULL;
+  param->shard = 0;
+  param->num_shards = 1;
+  param->shard_file = NULL;
+  param->max_frames = 0;
+  param->time_budget = 0.0;
+  param->split = NULL;
+
+  k = 1;
+  for (i = 1; i <= argc-1; i++) {
+    if ((strcmp(argv[i],"--replay") == 0) || (strcmp(argv[i],"--resume") == 0))
+      argv[i]++;		/* same as -replay and -resume */
+    if ((argv[i][0] != '-') || !isalpha((unsigned char)argv[i][1])) {
+      argv[k++] = argv[i];	/* positional argument */
+      continue;
+    }
+    if (i == argc-1) {
+      fprintf(stderr,"Option %s needs a value.\n",argv[i]);
+      exit(-1);
+    }
+    if (strcmp(argv[i],"-alg") == 0) {
+      i++;
+      if (strcmp(argv[i],"prob") == 0) param->algorithm = ALG_PROB;
+      else if (strcmp(argv[i],"llr") == 0) param->algorithm = ALG_LLR;
+      else if (strcmp(argv[i],"ms") == 0) param->algorithm = ALG_MS;
+      else if (strcmp(argv[i],"nms") == 0) param->algorithm = ALG_NMS;
+      else if (strcmp(argv[i],"oms") == 0) param->algorithm = ALG_OMS;
+      else if (strcmp(argv[i],"gala") == 0) param->algorithm = ALG_GALA;
+      else if (strcmp(argv[i],"galb") == 0) param->algorithm = ALG_GALB;
+      else if (strcmp(argv[i],"bf") == 0) param->algorithm = ALG_BF;
+      else {
+	fprintf(stderr,"Unknown algorithm %s.\n",argv[i]);
+	exit(-1);
+      }
+    }
+    else if (strcmp(argv[i],"-alpha") == 0) param->ms_scale = atof(argv[++i]);
+    else if (strcmp(argv[i],"-beta") == 0) param->ms_offset = atof(argv[++i]);
+    else if (strcmp(argv[i],"-q") == 0) param->qbits = atoi(argv[++i]);
+    else if (strcmp(argv[i],"-qch") == 0) param->qch_bits = atoi(argv[++i]);
+    else if (strcmp(argv[i],"-qstep") == 0) param->qstep = atof(argv[++i]);
+    else if (strcmp(argv[i],"-simd") == 0) param->simd = atoi(argv[++i]);
+    else if (strcmp(argv[i],"-sched") == 0) {
+      i++;
+      if (strcmp(argv[i],"flood") == 0) param->schedule = SCHED_FLOOD;
+      else if (strcmp(argv[i],"layered") == 0) param->schedule = SCHED_LAYERED;
+      else if (strcmp(argv[i],"shuffled") == 0) 
+	param->schedule = SCHED_SHUFFLED;
+      else if (strcmp(argv[i],"residual") == 0) 
+	param->schedule = SCHED_RESIDUAL;
+      else {
+	fprintf(stderr,"Unknown schedule %s.\n",argv[i]);
+	exit(-1);
+      }
+    }
+    else if (strcmp(argv[i],"-layers") == 0) {
+      param->layer_file = argv[++i];
+      param->schedule = SCHED_LAYERED;
+    }
+    else if (strcmp(argv[i],"-cgroup") == 0) param->col_group = atoi(argv[++i]);
+    else if (strcmp(argv[i],"-abandon") == 0) 
+      param->abandon_window = atoi(argv[++i]);
+    else if (strcmp(argv[i],"-j") == 0) param->threads = atoi(argv[++i]);
+    else if (strcmp(argv[i],"-batch") == 0) param->batch = atoi(argv[++i]);
+    else if (strcmp(argv[i],"-pipe") == 0) param->pipe_depth = atoi(argv[++i]);
+    else if (strcmp(argv[i],"-lanes") == 0) 
+      param->frame_lanes = atoi(argv[++i]);
+    else if (strcmp(argv[i],"-replay") == 0) param->replay = atoll(argv[++i]);
+    else if (strcmp(argv[i],"-rng") == 0) {
+      i++;
+      if (strcmp(argv[i],"philox") == 0) param->rng_type = RNG_PHILOX;
+      else if (strcmp(argv[i],"drand48") == 0) param->rng_type = RNG_DRAND48;
+      else {
+	fprintf(stderr,"Unknown random number generator %s.\n",argv[i]);
+	exit(-1);
+      }
+    }
+    else if (strcmp(argv[i],"-split") == 0) 
+      param->split_threads = atoi(argv[++i]);
+    else if (strcmp(argv[i],"-is") == 0) {
+      i++;
+      if (strcmp(argv[i],"off") == 0) param->is_method = IS_OFF;
+      else if (strcmp(argv[i],"shift") == 0) param->is_method = IS_SHIFT;
+      else if (strcmp(argv[i],"scale") == 0) param->is_method = IS_SCALE;
+      else {
+	fprintf(stderr,"Unknown importance sampling %s.\n",argv[i]);
+	exit(-1);
+      }
+    }
+    else if (strcmp(argv[i],"-isbias") == 0) param->is_bias = atof(argv[++i]);
+    else if (strcmp(argv[i],"-checkpoint") == 0) param->ck_file = argv[++i];
+    else if (strcmp(argv[i],"-ckint") == 0) 
+      param->ck_interval = atof(argv[++i]);
+    else if (strcmp(argv[i],"-resume") == 0) param->resume_file = argv[++i];
+    else if (strcmp(argv[i],"-shard") == 0) {
+      if (sscanf(argv[++i],"%d/%d",&param->shard,&param->num_shards) != 2) {
+	fprintf(stderr,"-shard should be K/S.\n");
+	exit(-1);
+      }
+    }
+    else if (strcmp(argv[i],"-shardout") == 0) param->shard_file = argv[++i];
+    else if (strcmp(argv[i],"-ci") == 0) param->ci_width = atof(argv[++i]);
+    else if (strcmp(argv[i],"-maxframes") == 0) 
+      param->max_frames = atoll(argv[++i]);
+    else if (strcmp(argv[i],"-time") == 0) 
+      param->time_budget = atof(argv[++i]);
+    else if (strcmp(argv[i],"-prec") == 0) {
+      i++;
+      if (strcmp(argv[i],"double") == 0) param->precision = PREC_DOUBLE;
+      else if (strcmp(argv[i],"float") == 0) param->precision = PREC_FLOAT;
+      else if (strcmp(argv[i],"compare") == 0) param->precision = PREC_COMPARE;
+      else {
+	fprintf(stderr,"Unknown precision %s.\n",argv[i]);
+	exit(-1);
+      }
+    }
+    else {
+      fprintf(stderr,"Unknown option %s.\n",argv[i]);
+      exit(-1);
+    }
+  }
+  argv[k] = NULL;
+				/* quantized decoder */
+  if (param->qch_bits == 0) param->qch_bits = param->qbits;
+  if (param->qbits > 0) {
+    if ((param->qbits < 2) || (param->qbits > 16) 
+	|| (param->qch_bits < 2) || (param->qch_bits > 16)
+	|| (param->qstep <= 0)) {
+      fprintf(stderr,"-q and -qch should be 2..16 and -qstep positive.\n");
+      exit(-1);
+    }
+    if ((param->algorithm != ALG_MS) && (param->algorithm != ALG_NMS)
+	&& (param->algorithm != ALG_OMS)) {
+      fprintf(stderr,"Quantized decoding needs -alg ms, nms or oms.\n");
+      exit(-1);
+    }
+    if (param->precision != PREC_DOUBLE) {
+      fprintf(stderr,"-prec can't be used with quantized decoding.\n");
+      exit(-1);
+    }
+    param->qmax = (1 << (param->qbits-1)) - 1;
+    param->qch_max = (1 << (param->qch_bits-1)) - 1;
+    param->qscale = (int)floor(param->ms_scale * 16.0 + 0.5);
+    param->qoffset = (int)floor(param->ms_offset / param->qstep + 0.5);
+  }
+  if (param->abandon_window < 0) {
+    fprintf(stderr,"-abandon should not be negative.\n");
+    exit(-1);
+  }
+				/* importance sampling; its points */
+				/* stop on the weighted estimate */
+  if (param->is_bias < 0.0) {
+    fprintf(stderr,"-isbias should be positive.\n");
+    exit(-1);
+  }
+  if (param->ci_width == -1.0) 
+    param->ci_width = (param->is_method != IS_OFF) ? IS_CI_WIDTH : 0.0;
+  if ((param->ci_width < 0) || (param->max_frames < 0) 
+      || (param->time_budget < 0)) {
+    fprintf(stderr,"-ci, -maxframes and -time should not be negative.\n");
+    exit(-1);
+  }
+  if (param->threads < 1) {
+    fprintf(stderr,"-j should be positive.\n");
+    exit(-1);
+  }
+  if ((param->replay >= 0) && (param->rng_type != RNG_PHILOX)) {
+    fprintf(stderr,"-replay needs -rng philox.\n");
+    exit(-1);
+  }
+				/* checkpoints */
+  if ((param->resume_file != NULL) && (param->ck_file == NULL)) 
+    param->ck_file = param->resume_file;
+  if ((param->ck_file != NULL) && (param->rng_type != RNG_PHILOX)) {
+    fprintf(stderr,"-checkpoint and -resume need -rng philox.\n");
+    exit(-1);
+  }
+				/* shards */
+  if ((param->num_shards < 1) || (param->shard < 0) 
+      || (param->shard >= param->num_shards)) {
+    fprintf(stderr,"-shard K/S needs 0 <= K < S.\n");
+    exit(-1);
+  }
+  if ((param->num_shards > 1) && (param->rng_type != RNG_PHILOX)) {
+    fprintf(stderr,"-shard needs -rng philox.\n");
+    exit(-1);
+  }
+  if (param->pipe_depth < 0) {
+    fprintf(stderr,"-pipe should not be negative.\n");
+    exit(-1);
+  }
+  if (param->split_threads < 1) {
+    fprintf(stderr,"-split should be positive.\n");
+    exit(-1);
+  }
+  if ((param->split_threads > 1) 
+      && ((param->schedule != SCHED_FLOOD) || (param->qbits > 0))) {
+    fprintf(stderr,"-split needs -sched flood and floating point decoding.\n");
+    exit(-1);
+  }
+				/* hard-decision decoders */
+  if ((param->algorithm >= ALG_GALA) 
+      && ((param->schedule != SCHED_FLOOD) || (param->split_threads > 1)
+	  || (param->precision == PREC_COMPARE))) {
+    fprintf(stderr,"-alg gala, galb and bf can't be used with -sched, "
+	    "-split or -prec compare.\n");
+    exit(-1);
+  }
+				/* multi-frame decoding, by default */
+				/* for the hard-decision decoders */
+  if (param->frame_lanes < 0) 
+    param->frame_lanes = (param->algorithm >= ALG_GALA) 
+      && (param->abandon_window == 0) && (param->pipe_depth == 0);
+  if (param->frame_lanes 
+      && (((param->algorithm != ALG_MS) && (param->algorithm != ALG_NMS)
+	   && (param->algorithm != ALG_OMS) && (param->algorithm < ALG_GALA))
+	  || (param->schedule != SCHED_FLOOD) || (param->qbits > 0)
+	  || (param->precision == PREC_COMPARE) || (param->abandon_window > 0)
+	  || (param->split_threads > 1) || (param->pipe_depth > 0))) {
+    fprintf(stderr,"-lanes needs -alg ms, nms, oms, gala, galb or bf, "
+	    "-sched flood and -prec double\nor float, and can't be used "
+	    "with -q, -abandon, -split or -pipe.\n");
+    exit(-1);
+  }
+				/* a batch fills the 64 lanes of */
+				/* the hard-decision decoders */
+  if (param->batch == -1) 
+    param->batch = ((param->algorithm >= ALG_GALA) && param->frame_lanes) 
+      ? HARD_LANES : 16;
+  if (param->batch < 1) {
+    fprintf(stderr,"-batch should be positive.\n");
+    exit(-1);
+  }
+				/* layered and shuffled schedules */
+  if (param->schedule != SCHED_FLOOD) {
+    if (param->qbits > 0) {
+      fprintf(stderr,"-sched can't be used with quantized decoding.\n");
+      exit(-1);
+    }
+    if (param->col_group < 1) {
+      fprintf(stderr,"-cgroup should be positive.\n");
+      exit(-1);
+    }
+				/* sum-product in the LLR domain */
+    if (param->algorithm == ALG_PROB) param->algorithm = ALG_LLR;
+  }
+  return k;
+}
+
 int main(int argc,char **argv)
 {
   FILE* fp;
   sparce_matrix s;
   simulation_parameters param;
-  int i;
+  sweep_state sweep;
+  worker* workers;
+  double* snr;
+  int i,k;
 				/* user interface */
+  argc = read_options(argc,argv,&param);
   if (argc < 3) {
     printf("usage : awgniterative file snr (maxitr seed stop #err disp)\n");
     printf("file  : parity check matrix (in spmat format)\n");
-    printf("snr   : Eb/N0\n");
+    printf("snr   : Eb/N0, a list (1.0,1.5) or a range (1.0:0.5:3.0)\n");
     printf("maxitr: maximum number of iterations\n");
     printf("seed  : seed for the random number generator\n");
     printf("stop  : = 0: simulation stops when #ebits becomes #err\n");
     printf("        = 1: simulation stops when #eblks becomes #err\n");
     printf("disp  : = 0: non display\n");
     printf("        = 1: display\n");
+    printf("options:\n");
+    printf("-alg  : prob = sum-product with probabilities (default)\n");
+    printf("        llr  = sum-product with log-likelihood ratios\n");
+    printf("        ms   = min-sum\n");
+    printf("        nms  = normalized min-sum\n");
+    printf("        oms  = offset min-sum\n");
+    printf("        gala, galb = Gallager-A, B (hard decision, 64 frames)\n");
+    printf("        bf   = parallel bit flipping (hard decision, 64 frames)\n");
+    printf("-alpha: scaling factor for nms (default 0.8)\n");
+    printf("-beta : offset for oms (default 0.15)\n");
+    printf("-q    : bits of a quantized message (ms/nms/oms only)\n");
+    printf("-qch  : bits of a quantized channel LLR (default: -q)\n");
+    printf("-qstep: LLR value of one quantization step (default 0.5)\n");
+    printf("-simd : 1 = vectorized check nodes (default), 0 = scalar\n");
+    printf("-sched: flood (default), layered, shuffled or residual\n");
+    printf("-layers: file of the layers (implies -sched layered)\n");
+    printf("-cgroup: columns per group of -sched shuffled (default 1)\n");
+    printf("-prec : double, float or compare (float vs double report)\n");
+    printf("-abandon: window of the failure predictor (default 0: off)\n");
+    printf("-is   : importance sampling, off (default), shift or scale\n");
+    printf("-isbias: mean shift or variance factor of -is\n");
+    printf("-checkpoint: file of the checkpoints\n");
+    printf("-ckint: seconds between checkpoints (default 60)\n");
+    printf("-resume: continue from a checkpoint file\n");
+    printf("-shard: K/S, shard K of S processes\n");
+    printf("-shardout: file of the record of the shard (see mergeshards)\n");
+    printf("-ci   : relative half width of the 95%% interval to stop\n");
+    printf("-maxframes: the most frames of a point (default: no limit)\n");
+    printf("-time : the most seconds of a point (default: no limit)\n");
+    printf("-j    : number of worker threads (default 1)\n");
+    printf("-rng  : philox (default) or drand48\n");
+    printf("-batch: frames per batch of a worker (default 16, 64 for gala/galb/bf)\n");
+    printf("-pipe : slots of the ring of a producer thread (default 0: off)\n");
+    printf("-lanes: 1 = decode LANES frames at a time (ms/nms/oms/gala/galb/bf)\n");
+    printf("-replay: decode frame number F alone with a trace\n");
+    printf("-split: threads decoding one frame (default 1)\n");
     exit(-1);
   }
+  param.file = argv[1];
   if ((fp = fopen(argv[1],"r")) == NULL) {
     fprintf(stderr,"Can't open %s.\n",argv[1]);
     exit(-1);
   }
-  param.snr = atof(argv[2]);
   if (argc >= 4) param.max_iteration = atoi(argv[3]);
   else param.max_iteration = 20; /* default maxi */
 
@@ -887,10 +4782,12 @@ int main(int argc,char **argv)
   if (argc >= 8) param.display = atoi(argv[7]);
   else param.display = 0;	/* default: non-display */
 
-				/* initialize random number generator */
-  srand48(param.seed);
 				/* reading spmat file */
   read_spmat_file(fp, &s);
+				/* default bias of -is */
+  if (param.is_bias == 0.0) 
+    param.is_bias = (param.is_method == IS_SCALE) 
+      ? 1.0 + 2.0 / sqrt(s.N) : 1.0 / sqrt(s.N);
   /* print_spmatrix_in_spmatform(&s); */
 
   /*
@@ -900,32 +4797,114 @@ int main(int argc,char **argv)
     * transmitted word is (+1,+1,....,+1).
     * The variance of noise is param.var.
    */
+  init_ziggurat();
+  if (param.replay >= 0) param.threads = 1;
+				/* SNR points of the sweep */
+  sweep.num_points = read_snr_list(argv[2],&snr);
+  sweep.batch = param.batch;
+  pthread_mutex_init(&sweep.lock,NULL);
+  pthread_mutex_init(&sweep.ck_lock,NULL);
+  sweep.ck_last = wall_time();
+  if ((sweep.point = (sweep_point*)aligned_alloc(CACHE_LINE,
+			 sizeof(sweep_point)*sweep.num_points)) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+  for (i = 0; i <= sweep.num_points-1; i++) {
+    atomic_init(&sweep.point[i].stop,0);
+    sweep.point[i].workers = 0;
+    sweep.point[i].next_batch = 0;
+    sweep.point[i].committed = 0;
+    sweep.point[i].ring_size = 4 * param.threads;
+    if (((sweep.point[i].ring = (simulation_parameters*)
+	  malloc(sizeof(simulation_parameters)*4*param.threads)) == NULL)
+	|| ((sweep.point[i].ring_done 
+	     = (int*)calloc(4*param.threads,sizeof(int))) == NULL)) {
+      fprintf(stderr,"Can't allocate memory\n");
+      exit(-1);
+    }
+    pthread_mutex_init(&sweep.point[i].lock,NULL);
+    pthread_cond_init(&sweep.point[i].cond,NULL);
+    sweep.point[i].result = param;
+    sweep.point[i].result.N = s.N;
+    sweep.point[i].result.M = s.M;
+    sweep.point[i].result.snr = snr[i];
 				/* compute variance */
-
-  param.var = 0.5 * (1.0/pow(10.0,param.snr/10.0)) 
-    * (double)s.N/(double)(s.N-s.M);
-				/* initialization of simulation parameters */
-  init_simulation_param(&s,&param);
-
-				/* simulation loop */
-  while(1) {
-    param.total_blocks++;
-    param.total_bits += param.N;
-    
-    awgn_channel(&s,&param);
-    sum_product_decoder(&s,&param);
-    error_count(&param);
-    if (param.display == 1) {
-      print_results(stderr,"****",&param);
+    sweep.point[i].result.var = 0.5 * (1.0/pow(10.0,snr[i]/10.0)) 
+      * (double)s.N/(double)(s.N-s.M);
+    clear_counters(&sweep.point[i].result);
+  }
+  if (param.resume_file != NULL) read_checkpoint(&sweep,&sweep.point[0].result);
+				/* initialization of the workers; */
+				/* worker k has the k-th stream and */
+				/* starts on point k (mod #points) */
+  if ((workers = (worker*)aligned_alloc(CACHE_LINE,
+					sizeof(worker)*param.threads)) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+  for (k = 0; k <= param.threads-1; k++) {
+    workers[k].param = param;
+    workers[k].s = &s;
+    workers[k].sweep = &sweep;
+    workers[k].current = k % sweep.num_points;
+    sweep.point[workers[k].current].workers++;
+    init_simulation_param(&s,&workers[k].param);
+    init_rng(&workers[k].param,k);
+    workers[k].pipe = NULL;
+    if (param.pipe_depth > 0) init_pipe(&workers[k],param.pipe_depth,k);
+    workers[k].lanes = NULL;
+    if (param.frame_lanes) init_lanes(&workers[k]);
+    if (param.split_threads > 1) init_split(&s,&workers[k].param);
+  }
+				/* replay of a frame at each point */
+  if (param.replay >= 0) {
+    for (i = 0; i <= sweep.num_points-1; i++) 
+      replay_frame(&workers[0],&sweep.point[i],param.replay,argv[1]);
+    exit(0);
+  }
+				/* SIGINT and SIGTERM end the run */
+				/* with the results so far; a */
+				/* second one kills */
+  {
+    struct sigaction sa;
+    memset(&sa,0,sizeof(sa));
+    sa.sa_handler = on_signal;
+    sa.sa_flags = SA_RESTART | SA_RESETHAND;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT,&sa,NULL);
+    sigaction(SIGTERM,&sa,NULL);
+  }
+				/* simulation loop (a single worker */
+				/* runs in the main thread) */
+  if (param.threads == 1) simulation_worker(&workers[0]);
+  else {
+    for (k = 0; k <= param.threads-1; k++) {
+      if (pthread_create(&workers[k].thread,NULL,
+			 simulation_worker,&workers[k]) != 0) {
+	fprintf(stderr,"Can't create a thread\n");
+	exit(-1);
+      }
     }
-				/* stop criteria 0 (stop = 0) */
-    if ((param.stop == 0) && (param.error_bits >= param.stop_err)) break;
-
-				/* stop criteria 1 (stop = 1) */
-    if ((param.stop == 1) && (param.error_blocks >= param.stop_err)) break;
+    for (k = 0; k <= param.threads-1; k++) 
+      pthread_join(workers[k].thread,NULL);
   }
+  if (param.ck_file != NULL) write_checkpoint(&sweep,&sweep.point[0].result);
+  if (param.shard_file != NULL) 
+    write_shard_record(&sweep,&sweep.point[0].result,argv[1]);
+  if (atomic_load(&interrupted)) 
+    fprintf(stderr,"Interrupted; the results so far follow.\n");
 				/* print results */
-  print_results(stdout,argv[1],&param);
+  for (i = 0; i <= sweep.num_points-1; i++) {
+    if (sweep.point[i].result.total_blocks == 0) continue;
+    print_results(stdout,argv[1],&sweep.point[i].result);
+    if (param.precision == PREC_COMPARE) 
+      print_precision_report(stdout,&sweep.point[i].result);
+    if (param.abandon_window > 0) 
+      print_abandon_report(stdout,&sweep.point[i].result);
+    if (param.is_method != IS_OFF) 
+      print_is_report(stdout,&sweep.point[i].result);
+  }
 
 }
 
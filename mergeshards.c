@@ -0,0 +1,291 @@
+/*
+  	FILENAME: mergeshards.c
+
+	NAME: mergeshards
+
+	SYNOPSYS: mergeshards record_file1 record_file2 ...
+
+	record_file : record of a shard, written by
+	              awgniterative or sawgniterative with
+	              -shard K/S -shardout record_file
+
+	Output format (that of awgniterative)
+	snr pb pB var #ebits #bits #eblks #blks aveitr
+	seed maxi N M file stop #err pb_lo pb_hi pB_lo pB_hi
+
+	DESCRIPTION:
+
+	The program adds up the counters of the shards of
+	a simulation point by point and prints the exact
+	totals with the 95% confidence intervals of pb and
+	pB (as awgniterative does; the interval of pb is
+	taken over frames). The shards of a point must come
+	from the same program, matrix, seed, -batch and
+	decoder options (those checked by -resume) and
+	have distinct K of the same S; a shard given
+	twice is an error, so no frame is counted twice.
+	Missing shards are reported on stderr (a partial
+	merge is still an unbiased estimate). With
+	importance sampling (-is) a #is: line gives the
+	weighted pb and pB and their variances.
+	stop and #err are those of a single shard.
+
+	EXAMPLE:
+	awgniterative -shard 0/2 -shardout r0 981.500 2.0 &
+	awgniterative -shard 1/2 -shardout r1 981.500 2.0 &
+	wait
+	mergeshards r0 r1
+
+	HOW TO MAKE:
+	gcc -O2 -o mergeshards mergeshards.c -lm
+
+	HISTORY:
+  	SINCE : Oct. 16, 2026
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define CI_Z 1.959964		/* 95% two-sided normal quantile */
+#define MAX_LINE 8192
+
+/* ================================================== */
+/*  A simulation point and the sum of its shards      */
+/* ================================================== */
+
+typedef struct _POINT
+{
+  char prog[32];		/* awgniterative or sawgniterative */
+  double snr;
+  double var;
+  int seed;
+  int max_iteration;
+  int N;
+  int M;
+  char file[FILENAME_MAX];	/* parity check matrix */
+  char options[MAX_LINE];	/* run_options of the #shard line */
+  int stop;
+  int stop_err;
+  int batch;
+  int num_shards;
+  char* seen;			/* seen[K] = 1: shard K is added */
+
+  long long total_blocks;	/* the counters of write_counters */
+  long long error_blocks;
+  long long total_bits;
+  long long error_bits;
+  double error_bits2;
+  long long num_iteration;
+  long long cmp[7];		/* float and abandonment counters */
+  double is_blocks;
+  double is_blocks2;
+  double is_bits;
+  double is_bits2;
+} merged_point;
+
+int num_points = 0;
+merged_point* point = NULL;
+
+/* ================================================== */
+/*  The point of a record line; a new one is added    */
+/*  when there is none with the same snr, program,    */
+/*  matrix, seed, maxi and shards.                    */
+/* ================================================== */
+
+merged_point* find_point(merged_point* r)
+{
+  int i;
+  merged_point* p;
+
+  for (i = 0; i <= num_points-1; i++) {
+    p = &point[i];
+    if ((fabs(p->snr - r->snr) <= 1e-9) && (strcmp(p->prog,r->prog) == 0)
+	&& (strcmp(p->file,r->file) == 0) && (p->seed == r->seed)
+	&& (p->max_iteration == r->max_iteration)) {
+      if ((p->N != r->N) || (p->M != r->M) || (p->batch != r->batch)
+	  || (p->num_shards != r->num_shards)
+	  || (strcmp(p->options,r->options) != 0)) {
+	fprintf(stderr,"Shards of snr %f differ in N, M, -batch, S "
+		"or options.\n",r->snr);
+	exit(-1);
+      }
+      return p;
+    }
+  }
+  if ((point = (merged_point*)realloc(point,
+		     sizeof(merged_point)*(num_points+1))) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+  p = &point[num_points++];
+  *p = *r;
+  if ((p->seen = (char*)calloc(r->num_shards,1)) == NULL) {
+    fprintf(stderr,"Can't allocate memory\n");
+    exit(-1);
+  }
+  p->total_blocks = p->error_blocks = p->total_bits = p->error_bits = 0;
+  p->error_bits2 = 0.0;
+  p->num_iteration = 0;
+  memset(p->cmp,0,sizeof(p->cmp));
+  p->is_blocks = p->is_blocks2 = p->is_bits = p->is_bits2 = 0.0;
+  return p;
+}
+
+/* ================================================== */
+/*  The function reads a record file and adds its     */
+/*  points.                                           */
+/* ================================================== */
+
+void read_record(char* name)
+{
+  FILE* fp;
+  char line[MAX_LINE];
+  merged_point r,*p;
+  int shard,k,len;
+  long long batches;
+
+  if ((fp = fopen(name,"r")) == NULL) {
+    fprintf(stderr,"Can't open %s.\n",name);
+    exit(-1);
+  }
+  if ((fgets(line,MAX_LINE,fp) == NULL)
+      || (sscanf(line,"#shard %31s %d %d %d %n",
+		 r.prog,&shard,&r.num_shards,&r.batch,&len) != 4)
+      || (shard < 0) || (shard >= r.num_shards)) {
+    fprintf(stderr,"%s is not a shard record.\n",name);
+    exit(-1);
+  }
+  line[strcspn(line,"\n")] = '\0';
+  strcpy(r.options,line+len);	/* options of all points */
+  while (fgets(line,MAX_LINE,fp) != NULL) {
+    if (sscanf(line,"%lf %lf %d %d %d %d %s %d %d %lld "
+	       "%lld %lld %lld %lld %lf %lld "
+	       "%lld %lld %lld %lld %lld %lld %lld "
+	       "%lf %lf %lf %lf",
+	       &r.snr,&r.var,&r.seed,&r.max_iteration,&r.N,&r.M,r.file,
+	       &r.stop,&r.stop_err,&batches,
+	       &r.total_blocks,&r.error_blocks,&r.total_bits,&r.error_bits,
+	       &r.error_bits2,&r.num_iteration,
+	       &r.cmp[0],&r.cmp[1],&r.cmp[2],&r.cmp[3],&r.cmp[4],
+	       &r.cmp[5],&r.cmp[6],
+	       &r.is_blocks,&r.is_blocks2,&r.is_bits,&r.is_bits2) != 27) {
+      fprintf(stderr,"Bad line in %s: %s",name,line);
+      exit(-1);
+    }
+    p = find_point(&r);
+    if (p->seen[shard]) {
+      fprintf(stderr,"Shard %d of snr %f is given twice (%s).\n",
+	      shard,r.snr,name);
+      exit(-1);
+    }
+    p->seen[shard] = 1;
+    p->total_blocks += r.total_blocks;
+    p->error_blocks += r.error_blocks;
+    p->total_bits += r.total_bits;
+    p->error_bits += r.error_bits;
+    p->error_bits2 += r.error_bits2;
+    p->num_iteration += r.num_iteration;
+    for (k = 0; k <= 6; k++) p->cmp[k] += r.cmp[k];
+    p->is_blocks += r.is_blocks;
+    p->is_blocks2 += r.is_blocks2;
+    p->is_bits += r.is_bits;
+    p->is_bits2 += r.is_bits2;
+  }
+  fclose(fp);
+}
+
+/* ================================================== */
+/*  Estimate of pb (bits = 1) or pB (bits = 0) and    */
+/*  the variance of the estimate (as error_rate of    */
+/*  awgniterative)                                    */
+/* ================================================== */
+
+void error_rate(merged_point* p, int bits, int weighted,
+		double* mean, double* var)
+{
+  double n,per;
+
+  n = p->total_blocks;
+  per = bits ? (double)p->total_bits / p->total_blocks : 1.0;
+  if (weighted) {
+    *mean = (bits ? p->is_bits : p->is_blocks) / (n * per);
+    *var = ((bits ? p->is_bits2 : p->is_blocks2) / (n * per * per)
+	    - *mean * *mean) / n;
+  }
+  else if (bits) {
+    *mean = p->error_bits / (n * per);
+    *var = (p->error_bits2 / (n * per * per) - *mean * *mean) / n;
+  }
+  else {
+    *mean = p->error_blocks / n;
+    *var = *mean * (1.0 - *mean) / n;
+  }
+  if (*var < 0.0) *var = 0.0;	/* rounding */
+}
+
+/* ================================================== */
+/*  print function for the merged results             */
+/* ================================================== */
+
+void print_point(merged_point* p)
+{
+  double pb,pB,vb,vB,lb,lB;
+  int k,found;
+
+  found = 0;
+  for (k = 0; k <= p->num_shards-1; k++) found += p->seen[k];
+  if (found < p->num_shards)
+    fprintf(stderr,"snr %f: %d of %d shards.\n",p->snr,found,p->num_shards);
+  if (p->total_blocks == 0) return;
+
+  error_rate(p,1,0,&pb,&vb);
+  error_rate(p,0,0,&pB,&vB);
+  lb = pb - CI_Z * sqrt(vb);
+  lB = pB - CI_Z * sqrt(vB);
+  printf("#snr pb pB var #eblks #blks #ebits #bits aveitr seed maxitr"
+	 " N M file stop #err pb_lo pb_hi pB_lo pB_hi\n");
+  printf("%16.12e %16.12e %16.12e %16.12e %lld %lld %lld %lld %f %d %d %d %d %s %d %d %16.12e %16.12e %16.12e %16.12e\n",
+	 p->snr,
+	 pb,
+	 pB,
+	 p->var,
+	 p->error_bits,
+	 p->total_bits,
+	 p->error_blocks,
+	 p->total_blocks,
+	 (double)p->num_iteration/p->total_blocks,
+	 p->seed,
+	 p->max_iteration,
+	 p->N,
+	 p->M,
+	 p->file,
+	 p->stop,
+	 p->stop_err,
+	 (lb > 0.0) ? lb : 0.0, pb + CI_Z * sqrt(vb),
+	 (lB > 0.0) ? lB : 0.0, pB + CI_Z * sqrt(vB)
+	 );
+  printf("#merge: %d of %d shards\n",found,p->num_shards);
+  if (p->is_blocks + p->is_bits > 0.0) {
+    error_rate(p,1,1,&pb,&vb);
+    error_rate(p,0,1,&pB,&vB);
+    printf("#is: pb pB var(pb) var(pB) re(pB)\n");
+    printf("#is: %16.12e %16.12e %16.12e %16.12e %f\n",
+	   pb,pB,vb,vB,(pB > 0) ? sqrt(vB) / pB : 0.0);
+  }
+}
+
+int main(int argc,char **argv)
+{
+  int i;
+
+  if (argc < 2) {
+    printf("usage : mergeshards record_file1 record_file2 ...\n");
+    printf("record_file: -shardout file of awgniterative or sawgniterative\n");
+    exit(-1);
+  }
+  for (i = 1; i <= argc-1; i++) read_record(argv[i]);
+  for (i = 0; i <= num_points-1; i++) print_point(&point[i]);
+  return 0;
+}